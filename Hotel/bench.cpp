@@ -0,0 +1,606 @@
+// Benchmarks for the SQLite engine (dbms.cpp) and the flat-file engine (hotel.cpp)
+//
+// Build: g++ -std=c++17 -O2 -pthread -o bench Hotel/bench.cpp -lsqlite3
+// Usage: bench [--items N] [--sales N,N,...] [--users N] [--rooms N] [--readers N]
+//              [--properties N] [--iterations N] [--seconds S] [--dir PATH] [--stats]
+//
+// Each engine is compiled into its own namespace with its main() renamed, so
+// both can be driven from one process. Results are printed one JSON object per
+// line: engine, benchmark, dataset sizes, ops/sec and p50/p99 latency in microseconds.
+
+// Every header the engines include must be listed here first; inside the
+// namespaces below their own #include lines are then no-ops.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ctime>
+#include <unordered_map>
+#include <filesystem>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <deque>
+#include <condition_variable>
+#include <future>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+#include <type_traits>
+#include <iterator>
+#include <charconv>
+#include <string_view>
+#include <sqlite3.h>
+#include <zlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trace.h"
+
+#define main dbms_main
+namespace dbms {
+#include "dbms.cpp"
+}
+#undef main
+
+#define main hotel_main
+namespace flatfile {
+#include "hotel.cpp"
+}
+#undef main
+
+// Results keep going to the real stdout while benchmarks silence std::cout
+static std::ostream results(std::cout.rdbuf());
+
+struct BenchConfig {
+    int items = 100;
+    std::vector<long> salesSizes = {10, 10000, 1000000};
+    int users = 100;
+    int rooms = 1000;
+    int readers = 2;
+    int properties = 4;
+    int iterations = 20000;
+    double seconds = 1.0;
+    std::string dir = "bench_data";
+    bool queryStats = false;    // collect query statistics and save them to query_stats.json
+};
+
+// Run op until the iteration cap or the time budget is reached, then print one result line
+static void runBench(const BenchConfig& config, const std::string& engine, const std::string& name,
+                     long sales, const std::function<void(int)>& op) {
+    using Clock = std::chrono::steady_clock;
+    
+    std::vector<double> latencies;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration<double>(config.seconds);
+    
+    for (int i = 0; i < config.iterations; i++) {
+        auto before = Clock::now();
+        op(i);
+        auto after = Clock::now();
+        
+        latencies.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+        if (after >= deadline && latencies.size() >= 5) {
+            break;
+        }
+    }
+    
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    
+    auto percentile = [&latencies](double p) {
+        size_t index = static_cast<size_t>(p * (latencies.size() - 1));
+        return latencies[index];
+    };
+    
+    results << std::fixed << std::setprecision(2)
+            << "{\"engine\":\"" << engine << "\",\"bench\":\"" << name << "\""
+            << ",\"items\":" << config.items << ",\"sales\":" << sales
+            << ",\"ops\":" << latencies.size()
+            << ",\"ops_per_sec\":" << latencies.size() / elapsed
+            << ",\"p50_us\":" << percentile(0.50)
+            << ",\"p99_us\":" << percentile(0.99) << "}" << std::endl;
+}
+
+// Discards program output while a benchmark runs
+class QuietStdout {
+private:
+    std::streambuf* saved;
+    std::ostringstream sink;
+
+public:
+    QuietStdout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+    
+    void clear() { sink.str(""); }
+};
+
+static void seedDatabase(const BenchConfig& config, long sales) {
+    dbms::Database& db = dbms::Database::getInstance();
+    
+    db.executeQuery("BEGIN");
+    db.executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < " +
+                    std::to_string(config.items) + ") "
+                    "INSERT OR IGNORE INTO inventory (name, price, quantity, category) "
+                    "SELECT 'Item ' || x, 50 + x % 200, 0, "
+                    "CASE x % 3 WHEN 0 THEN 'food' WHEN 1 THEN 'drink' ELSE 'accommodation' END FROM n");
+    db.executeQuery("UPDATE inventory SET quantity = 1000000000");
+    db.executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < " +
+                    std::to_string(config.users) + ") "
+                    "INSERT OR IGNORE INTO users (username, password, role) "
+                    "SELECT 'user' || x, 'pass' || x, 'staff' FROM n");
+    
+    // Sales spread over the last year, so roughly 1/365 of them fall on today.
+    // Ids follow time, as they do for real sales.
+    db.executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < " +
+                    std::to_string(sales) + ") "
+                    "INSERT INTO sales (item_id, quantity, total_price, user_id, timestamp) "
+                    "SELECT 1 + x % (SELECT COUNT(*) FROM inventory), 1, 100, 1, "
+                    "datetime('now', '-' || ((" + std::to_string(sales) + " - x) * 365 / " +
+                    std::to_string(std::max(1L, sales)) + ") || ' days') FROM n");
+    
+    // Extra rooms for the 'Room' item, each with about 20 stays over the next two years
+    db.executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < " +
+                    std::to_string(config.rooms) + ") "
+                    "INSERT OR IGNORE INTO rooms (item_id, number) "
+                    "SELECT (SELECT id FROM inventory WHERE name = 'Room'), 'B' || x FROM n");
+    db.executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < " +
+                    std::to_string(config.rooms * 20) + ") "
+                    "INSERT INTO reservations (room_id, user_id, check_in, check_out) "
+                    "SELECT 1 + x % (SELECT COUNT(*) FROM rooms), 1, "
+                    "DATE('now', '+' || (x * 7919 % 700) || ' days'), "
+                    "DATE('now', '+' || (x * 7919 % 700 + 1 + x % 7) || ' days') FROM n");
+    db.executeQuery("COMMIT");
+}
+
+// Delete the monthly sales archives a previous run left next to path
+static void removeSalesArchives(const std::string& path) {
+    std::string prefix = path.substr(0, path.size() - 3) + ".sales-";
+    DIR* dir = ::opendir(".");
+    if (!dir) {
+        return;
+    }
+    while (dirent* entry = ::readdir(dir)) {
+        if (std::strncmp(entry->d_name, prefix.c_str(), prefix.size()) == 0) {
+            std::remove(entry->d_name);
+        }
+    }
+    ::closedir(dir);
+}
+
+static void benchDatabase(const BenchConfig& config, long sales) {
+    std::string path = "bench_" + std::to_string(sales) + ".db";
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    removeSalesArchives(path);
+    
+    dbms::Database& db = dbms::Database::getInstance();
+    
+    dbms::DatabaseConfig dbConfig;
+    dbConfig.readerPoolSize = std::max(1, config.readers);
+    dbConfig.queryStats = config.queryStats;
+    
+    if (!db.connect(path, dbConfig)) {
+        return;
+    }
+    seedDatabase(config, sales);
+    dbms::InventoryManager::invalidateCatalog();
+    
+    int itemCount = static_cast<int>(dbms::InventoryManager::getAllItems().size());
+    std::ostringstream out;
+    
+    runBench(config, "sqlite", "processOrder", sales, [&](int i) {
+        out.str("");
+        dbms::OrderManager::processOrder(1 + i % itemCount, 1, 1, out);
+    });
+    
+    runBench(config, "sqlite", "authenticateUser", sales, [&](int i) {
+        int user = 1 + i % config.users;
+        dbms::UserManager::authenticateUser("user" + std::to_string(user), "pass" + std::to_string(user));
+    });
+    
+    runBench(config, "sqlite", "getAllItems", sales, [&](int) {
+        dbms::InventoryManager::getAllItems();
+    });
+    
+    int roomItem = 0;
+    {
+        dbms::Statement stmt = db.prepare("SELECT id FROM inventory WHERE name = 'Room'");
+        roomItem = stmt.step() ? stmt.getInt(0) : 0;
+    }
+    int today = 0;
+    dbms::ReservationManager::parseDate(dbms::ReservationManager::todayDate(), today);
+    
+    runBench(config, "sqlite", "findAvailable(3 nights/60 days)", sales, [&](int i) {
+        dbms::RoomBooking found;
+        std::string earliest = dbms::ReservationManager::formatDate(today + i % 300);
+        dbms::ReservationManager::findAvailable(roomItem, 3, earliest, 60, found);
+    });
+    
+    runBench(config, "sqlite", "countAvailable", sales, [&](int i) {
+        std::string checkIn = dbms::ReservationManager::formatDate(today + i % 300);
+        dbms::ReservationManager::countAvailable(roomItem, checkIn, 3);
+    });
+    
+    runBench(config, "sqlite", "bookRoom", sales, [&](int i) {
+        out.str("");
+        dbms::RoomBooking booking;
+        std::string checkIn = dbms::ReservationManager::formatDate(today + i * 31 % 700);
+        dbms::ReservationManager::bookRoom(roomItem, checkIn, 1, 1, booking, out);
+    });
+    
+    runBench(config, "sqlite", "displayDailySales", sales, [&](int) {
+        out.str("");
+        dbms::ReportManager::displayDailySales(out);
+    });
+    
+    // Last twelve months by item; the first call also loads the sales columns
+    long long yearAgo = (today - 365) * 86400LL;
+    long long tomorrow = (today + 1) * 86400LL;
+    runBench(config, "sqlite", "revenue(month,item)", sales, [&](int) {
+        dbms::SalesAnalytics::revenue(dbms::TimeBucket::Month, dbms::SalesDimension::Item, yearAgo, tomorrow);
+    });
+    
+    runBench(config, "sqlite", "revenue(hour,user)", sales, [&](int) {
+        dbms::SalesAnalytics::revenue(dbms::TimeBucket::Hour, dbms::SalesDimension::User, yearAgo, tomorrow);
+    });
+    
+    runBench(config, "sqlite", "exportSalesReport", sales, [&](int) {
+        out.str("");
+        dbms::ReportManager::exportSalesReport(out);
+    });
+    
+    runBench(config, "sqlite", "exportSalesRange(gzip)", sales, [&](int) {
+        out.str("");
+        std::string today = dbms::ReservationManager::formatDate(static_cast<int>(std::time(nullptr) / 86400));
+        dbms::ReportManager::exportSalesRange(today, today, true, out);
+    });
+    
+    // Every sales row, copying the timestamp into a std::string or viewing it in place
+    size_t scanned = 0;
+    runBench(config, "sqlite", "scanSales(getText)", sales, [&](int) {
+        dbms::Statement stmt = db.prepareRead("SELECT id, item_id, quantity, timestamp FROM sales");
+        while (stmt.step()) {
+            scanned += stmt.getInt(1) + stmt.getInt(2) + stmt.getText(3).size();
+        }
+    });
+    
+    runBench(config, "sqlite", "scanSales(rows)", sales, [&](int) {
+        dbms::Statement stmt = db.prepareRead("SELECT id, item_id, quantity, timestamp FROM sales");
+        for (auto [id, itemId, quantity, timestamp] : stmt.rows<long long, int, int, std::string_view>()) {
+            scanned += itemId + quantity + timestamp.size();
+        }
+    });
+    
+    // Orders while other threads keep running the daily report
+    if (config.readers > 0) {
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> readers;
+        
+        for (int r = 0; r < config.readers; r++) {
+            readers.emplace_back([&stop] {
+                std::ostringstream report;
+                while (!stop) {
+                    report.str("");
+                    dbms::ReportManager::displayDailySales(report);
+                }
+            });
+        }
+        
+        runBench(config, "sqlite", "processOrder+" + std::to_string(config.readers) + "readers", sales, [&](int i) {
+            out.str("");
+            dbms::OrderManager::processOrder(1 + i % itemCount, 1, 1, out);
+        });
+        
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+    }
+    
+    // Orders while the sales older than hotSalesDays (about three quarters) move to monthly archives
+    {
+        std::thread archiver([] {
+            std::ostringstream report;
+            dbms::SalesArchive::archiveOldSales(report);
+        });
+        
+        runBench(config, "sqlite", "processOrder+archival", sales, [&](int i) {
+            out.str("");
+            dbms::OrderManager::processOrder(1 + i % itemCount, 1, 1, out);
+        });
+        
+        archiver.join();
+    }
+    
+    db.close();
+}
+
+// Orders spread over several properties, and one revenue report across all of them
+static void benchProperties(const BenchConfig& config, long sales) {
+    dbms::DatabaseConfig dbConfig;
+    dbConfig.readerPoolSize = std::max(1, config.readers);
+    dbConfig.queryStats = config.queryStats;
+    
+    for (int p = 1; p <= config.properties; p++) {
+        std::string path = "property_" + std::to_string(p) + ".db";
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        std::remove((path + "-shm").c_str());
+        
+        int id = dbms::PropertyRouter::addProperty("Property " + std::to_string(p), path, dbConfig);
+        if (!id) {
+            return;
+        }
+        
+        dbms::PropertyScope scope(dbms::PropertyRouter::database(id));
+        seedDatabase(config, sales);
+        dbms::InventoryManager::invalidateCatalog();
+        dbms::SalesAnalytics::invalidate();
+    }
+    
+    int itemCount = config.items;
+    std::string suffix = "@" + std::to_string(config.properties) + "properties";
+    std::ostringstream out;
+    
+    runBench(config, "sqlite", "processOrder" + suffix, sales, [&](int i) {
+        dbms::PropertyScope scope(dbms::PropertyRouter::database(1 + i % config.properties));
+        out.str("");
+        dbms::OrderManager::processOrder(1 + i % itemCount, 1, 1, out);
+    });
+    
+    int today;
+    dbms::ReservationManager::parseDate(dbms::ReservationManager::todayDate(), today);
+    long long yearAgo = (today - 365) * 86400LL;
+    long long tomorrow = (today + 1) * 86400LL;
+    
+    runBench(config, "sqlite", "revenue(month,item) one by one" + suffix, sales, [&](int) {
+        for (int p = 1; p <= config.properties; p++) {
+            dbms::PropertyScope scope(dbms::PropertyRouter::database(p));
+            dbms::SalesAnalytics::revenue(dbms::TimeBucket::Month, dbms::SalesDimension::Item, yearAgo, tomorrow);
+        }
+    });
+    
+    runBench(config, "sqlite", "revenue(month,item) fan-out" + suffix, sales, [&](int) {
+        dbms::PropertyRouter::fanOut<std::vector<dbms::RevenueRow>>([&](const dbms::Property&) {
+            return dbms::SalesAnalytics::revenue(dbms::TimeBucket::Month, dbms::SalesDimension::Item, yearAgo, tomorrow);
+        });
+    });
+    
+    dbms::PropertyRouter::closeAll();
+}
+
+// Connecting to a fresh and to an already bootstrapped database, and single-item
+// orders (one commit each), under every storage profile
+static void benchProfiles(const BenchConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    for (dbms::StorageProfile profile : {dbms::StorageProfile::Durable, dbms::StorageProfile::Balanced,
+                                         dbms::StorageProfile::Fast}) {
+        std::string name = dbms::storageProfileName(profile);
+        std::string path = "profile_" + name + ".db";
+        std::remove(path.c_str());
+        std::remove((path + "-wal").c_str());
+        std::remove((path + "-shm").c_str());
+        
+        dbms::Database& db = dbms::Database::getInstance();
+        dbms::DatabaseConfig dbConfig;
+        dbConfig.profile = profile;
+        dbConfig.queryStats = config.queryStats;
+        
+        auto start = Clock::now();
+        if (!db.connect(path, dbConfig)) {
+            return;
+        }
+        double bootstrapUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        results << std::fixed << std::setprecision(2)
+                << "{\"engine\":\"sqlite\",\"bench\":\"connect(new database)[" << name << "]\""
+                << ",\"ops\":1,\"p50_us\":" << bootstrapUs << "}" << std::endl;
+        
+        runBench(config, "sqlite", "connect[" + name + "]", 0, [&](int) {
+            db.close();
+            db.connect(path, dbConfig);
+        });
+        
+        db.executeQuery("UPDATE inventory SET quantity = 1000000000");
+        dbms::InventoryManager::invalidateCatalog();
+        int itemCount = static_cast<int>(dbms::InventoryManager::getAllItems().size());
+        std::ostringstream out;
+        
+        runBench(config, "sqlite", "processOrder[" + name + "]", 0, [&](int i) {
+            out.str("");
+            dbms::OrderManager::processOrder(1 + i % itemCount, 1, 1, out);
+        });
+        
+        db.close();
+    }
+}
+
+static void benchFlatFile(const BenchConfig& config) {
+    std::remove("hotel_data.txt");
+    std::remove("customer_log.txt");
+    
+    {
+        std::ofstream data("hotel_data.txt");
+        for (int i = 1; i <= config.items; i++) {
+            data << "Item " << i << "," << 50 + i % 200 << ",1000000000,0\n";
+        }
+    }
+    
+    // The flat-file engine prints everything to std::cout
+    QuietStdout quiet;
+    flatfile::Hotel hotel;
+    
+    runBench(config, "flatfile", "processOrder", 0, [&](int i) {
+        quiet.clear();
+        hotel.placeOrder(i % hotel.getInventorySize(), 1);
+    });
+    
+    runBench(config, "flatfile", "saveData", 0, [&](int) {
+        hotel.saveData();
+    });
+    
+    // Startup with popular items: 500k units sold each
+    const int sold = 500000;
+    {
+        std::ofstream text("load.txt");
+        std::ofstream binary("load.bin", std::ios::binary);
+        auto writeInt = [&binary](int32_t value) {
+            binary.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        
+        binary.write("HOTB", 4);
+        writeInt(1);
+        writeInt(0);
+        writeInt(config.items);
+        
+        for (int i = 1; i <= config.items; i++) {
+            std::string name = "Item " + std::to_string(i);
+            text << name << "," << 50 + i % 200 << ",1000000000," << sold << "\n";
+            
+            writeInt(static_cast<int32_t>(name.size()));
+            binary.write(name.data(), name.size());
+            writeInt(50 + i % 200);
+            writeInt(1000000000);
+            writeInt(sold);
+        }
+    }
+    
+    runBench(config, "flatfile", "loadData(text)", 0, [&](int) {
+        flatfile::Hotel loaded("load.txt");
+    });
+    
+    runBench(config, "flatfile", "loadData(binary)", 0, [&](int) {
+        flatfile::Hotel loaded("load.bin");
+    });
+}
+
+// Item::order from several threads at once, each on its own item or all on one
+static void benchItemScaling(const BenchConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    
+    for (bool shared : {false, true}) {
+        for (int threads : {1, 2, 4, 8}) {
+            std::vector<flatfile::Item> items(threads, flatfile::Item("Item", 100, 2000000000));
+            std::vector<long> counts(threads, 0);
+            std::atomic<bool> stop(false);
+            std::vector<std::thread> workers;
+            
+            auto start = Clock::now();
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t] {
+                    flatfile::Item& item = items[shared ? 0 : t];
+                    long done = 0;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        for (int i = 0; i < 1000; i++) {
+                            item.order(1);
+                        }
+                        done += 1000;
+                    }
+                    counts[t] = done;
+                });
+            }
+            
+            std::this_thread::sleep_for(std::chrono::duration<double>(config.seconds));
+            stop = true;
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            
+            long total = 0;
+            for (long count : counts) {
+                total += count;
+            }
+            
+            results << std::fixed << std::setprecision(2)
+                    << "{\"engine\":\"flatfile\",\"bench\":\"Item::order(" << (shared ? "one item" : "own item") << ")\""
+                    << ",\"threads\":" << threads
+                    << ",\"ops\":" << total
+                    << ",\"ops_per_sec\":" << total / elapsed << "}" << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--items" && hasValue) {
+            config.items = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--users" && hasValue) {
+            config.users = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rooms" && hasValue) {
+            config.rooms = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--readers" && hasValue) {
+            config.readers = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--properties" && hasValue) {
+            config.properties = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            config.iterations = std::max(5, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            config.seconds = std::atof(argv[++i]);
+        } else if (arg == "--stats") {
+            config.queryStats = true;
+        } else if (arg == "--dir" && hasValue) {
+            config.dir = argv[++i];
+        } else if (arg == "--sales" && hasValue) {
+            config.salesSizes.clear();
+            std::istringstream sizes(argv[++i]);
+            std::string size;
+            while (std::getline(sizes, size, ',')) {
+                config.salesSizes.push_back(std::atol(size.c_str()));
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--items N] [--sales N,N,...] [--users N] [--rooms N] [--readers N]"
+                      << " [--properties N] [--iterations N] [--seconds S] [--dir PATH] [--stats]" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Benchmark files (databases, reports, logs) are kept out of the working directory
+    ::mkdir(config.dir.c_str(), 0755);
+    if (::chdir(config.dir.c_str()) != 0) {
+        std::cerr << "Cannot enter " << config.dir << std::endl;
+        return 1;
+    }
+    
+    for (long sales : config.salesSizes) {
+        benchDatabase(config, sales);
+    }
+    
+    if (config.properties > 0 && !config.salesSizes.empty()) {
+        benchProperties(config, config.salesSizes[std::min<size_t>(1, config.salesSizes.size() - 1)]);
+    }
+    
+    benchProfiles(config);
+    benchFlatFile(config);
+    benchItemScaling(config);
+    
+    if (config.queryStats) {
+        dbms::QueryStats::writeJson("query_stats.json");
+    }
+    
+    return 0;
+}
@@ -3,12 +3,44 @@
 #include <vector>
 #include <memory>
 #include <sqlite3.h>
+#include <zlib.h>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
 #include <functional>
 #include <fstream>
 #include <limits>
+#include <unordered_map>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <deque>
+#include <condition_variable>
+#include <future>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "trace.h"
 
 // Modern C++ Hotel Management System with SQLite Database
 
@@ -16,497 +48,4874 @@
 class Item;
 class InventoryManager;
 class OrderManager;
+class ReservationManager;
 class ReportManager;
 class UserManager;
 class Database;
+class Transaction;
 
-// Database singleton class
-class Database {
+// Per-query counters and latency histograms, keyed by SQL text.
+// Collection is off by default; when off, each statement pays one relaxed
+// atomic load. Records are created once and never freed, so statements can
+// keep a pointer to theirs for as long as they are cached.
+class QueryStats {
+public:
+    // Latency histogram with 8 linear sub-buckets per power of two of
+    // nanoseconds (values within 12.5%), up to about 18 minutes
+    static const int subBucketBits = 3;
+    static const int maxMagnitude = 40;
+    static const int bucketCount = (maxMagnitude - subBucketBits + 1) << subBucketBits;
+    
+    struct Record {
+        std::string sql;
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> rows{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> maxNs{0};
+        std::atomic<uint64_t> fullscanSteps{0};
+        std::atomic<uint64_t> sorts{0};
+        std::atomic<uint64_t> vmSteps{0};
+        std::atomic<uint64_t> histogram[bucketCount] = {};
+        
+        explicit Record(const std::string& sql) : sql(sql) {}
+        
+        void add(uint64_t ns, uint64_t rowCount) {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            rows.fetch_add(rowCount, std::memory_order_relaxed);
+            totalNs.fetch_add(ns, std::memory_order_relaxed);
+            histogram[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+            
+            uint64_t seen = maxNs.load(std::memory_order_relaxed);
+            while (ns > seen && !maxNs.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+            }
+        }
+        
+        // Upper bound of the bucket holding the given fraction of calls
+        uint64_t percentileNs(double fraction) const {
+            uint64_t total = 0;
+            for (const auto& count : histogram) {
+                total += count.load(std::memory_order_relaxed);
+            }
+            
+            uint64_t target = static_cast<uint64_t>(fraction * total);
+            uint64_t seen = 0;
+            for (int i = 0; i < bucketCount; i++) {
+                seen += histogram[i].load(std::memory_order_relaxed);
+                if (seen > target) {
+                    return std::min(bucketLimit(i), maxNs.load(std::memory_order_relaxed));
+                }
+            }
+            return maxNs.load(std::memory_order_relaxed);
+        }
+    };
+    
+    using Clock = std::chrono::steady_clock;
+    
 private:
-    sqlite3* db;
-    static Database* instance;
+    static std::atomic<bool> enabled;
+    static std::mutex registryMutex;
     
-    Database() : db(nullptr) {}
+    // Leaked on purpose: records must outlive every cached statement
+    static std::unordered_map<std::string, std::unique_ptr<Record>>& registry() {
+        static auto* records = new std::unordered_map<std::string, std::unique_ptr<Record>>();
+        return *records;
+    }
     
-public:
-    static Database& getInstance() {
-        if (!instance) {
-            instance = new Database();
+    static int bucketFor(uint64_t ns) {
+        if (ns < (1u << subBucketBits)) {
+            return static_cast<int>(ns);
         }
-        return *instance;
+        
+        int magnitude = 63;
+        while (!(ns >> magnitude)) {
+            magnitude--;
+        }
+        if (magnitude > maxMagnitude) {
+            return bucketCount - 1;
+        }
+        
+        int subBucket = static_cast<int>((ns >> (magnitude - subBucketBits)) & ((1 << subBucketBits) - 1));
+        return ((magnitude - subBucketBits + 1) << subBucketBits) + subBucket;
     }
     
-    bool connect(const std::string& dbName = "hotel.db") {
-        int rc = sqlite3_open(dbName.c_str(), &db);
-        if (rc) {
-            std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << std::endl;
-            return false;
+    static uint64_t bucketLimit(int bucket) {
+        if (bucket < (1 << subBucketBits)) {
+            return bucket + 1;
         }
         
-        initializeTables();
-        return true;
+        int magnitude = (bucket >> subBucketBits) + subBucketBits - 1;
+        uint64_t subBucket = bucket & ((1 << subBucketBits) - 1);
+        return ((1ULL << subBucketBits) + subBucket + 1) << (magnitude - subBucketBits);
     }
     
-    bool executeQuery(const std::string& query) {
-        char* errMsg = nullptr;
-        int rc = sqlite3_exec(db, query.c_str(), nullptr, nullptr, &errMsg);
-        
-        if (rc != SQLITE_OK) {
-            std::cerr << "SQL error: " << errMsg << std::endl;
-            sqlite3_free(errMsg);
-            return false;
+#ifndef _WIN32
+    static volatile std::sig_atomic_t dumpRequested;
+    
+    static void onDumpSignal(int) {
+        dumpRequested = 1;
+    }
+#endif
+    
+public:
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    
+    static void setEnabled(bool on) {
+        enabled = on;
+#ifndef _WIN32
+        // From then on, kill -USR1 <pid> writes the statistics to query_stats.json
+        if (on) {
+            dumpOnSignal("query_stats.json");
         }
-        return true;
+#endif
     }
     
-    // Callback for select queries
-    using ResultCallback = std::function<void(int, char**, char**)>;
+    // Record for a query text, created on first use
+    static Record* recordFor(const std::string& sql) {
+        std::lock_guard<std::mutex> guard(registryMutex);
+        
+        std::unique_ptr<Record>& record = registry()[sql];
+        if (!record) {
+            record = std::make_unique<Record>(sql);
+        }
+        return record.get();
+    }
     
-    bool executeSelect(const std::string& query, ResultCallback callback) {
-        char* errMsg = nullptr;
-        int rc = sqlite3_exec(db, query.c_str(), 
-            [](void* data, int argc, char** argv, char** azColName) -> int {
-                ResultCallback* cb = static_cast<ResultCallback*>(data);
-                if (cb) (*cb)(argc, argv, azColName);
-                return 0;
-            }, &callback, &errMsg);
+    // Records with at least one call, slowest total time first
+    static std::vector<const Record*> snapshot() {
+        std::vector<const Record*> records;
+        {
+            std::lock_guard<std::mutex> guard(registryMutex);
+            for (const auto& entry : registry()) {
+                if (entry.second->calls.load(std::memory_order_relaxed) > 0) {
+                    records.push_back(entry.second.get());
+                }
+            }
+        }
         
-        if (rc != SQLITE_OK) {
-            std::cerr << "SQL error: " << errMsg << std::endl;
-            sqlite3_free(errMsg);
-            return false;
+        std::sort(records.begin(), records.end(), [](const Record* a, const Record* b) {
+            return a->totalNs.load() > b->totalNs.load();
+        });
+        return records;
+    }
+    
+    static void reset() {
+        std::lock_guard<std::mutex> guard(registryMutex);
+        for (auto& entry : registry()) {
+            Record& record = *entry.second;
+            record.calls = 0;
+            record.rows = 0;
+            record.totalNs = 0;
+            record.maxNs = 0;
+            record.fullscanSteps = 0;
+            record.sorts = 0;
+            record.vmSteps = 0;
+            for (auto& count : record.histogram) {
+                count = 0;
+            }
         }
-        return true;
     }
     
-    void close() {
-        if (db) {
-            sqlite3_close(db);
-            db = nullptr;
+    static void display(std::ostream& out = std::cout) {
+        std::vector<const Record*> records = snapshot();
+        
+        out << "\n\tQuery Statistics (" << (isEnabled() ? "collecting" : "off") << ")\n";
+        out << "\n----------------------------------------------------------------------------------------------";
+        out << "\n   Calls       Rows   Mean us    p50 us    p99 us    Max us  Fullscan   Sorts   Query";
+        out << "\n----------------------------------------------------------------------------------------------";
+        
+        out << std::fixed << std::setprecision(1);
+        for (const Record* record : records) {
+            uint64_t calls = record->calls.load();
+            std::string sql = record->sql.size() > 60 ? record->sql.substr(0, 57) + "..." : record->sql;
+            
+            out << "\n" << std::setw(8) << calls
+                << std::setw(11) << record->rows.load()
+                << std::setw(10) << record->totalNs.load() / 1000.0 / calls
+                << std::setw(10) << record->percentileNs(0.50) / 1000.0
+                << std::setw(10) << record->percentileNs(0.99) / 1000.0
+                << std::setw(10) << record->maxNs.load() / 1000.0
+                << std::setw(10) << record->fullscanSteps.load()
+                << std::setw(8) << record->sorts.load()
+                << "   " << sql;
         }
+        out.unsetf(std::ios::fixed);
+        
+        out << "\n----------------------------------------------------------------------------------------------\n";
     }
     
-    ~Database() {
-        close();
+    static bool writeJson(const std::string& path) {
+        std::ofstream file(path);
+        if (!file) {
+            std::cerr << "Error: Unable to write " << path << std::endl;
+            return false;
+        }
+        
+        auto escape = [](const std::string& text) {
+            std::string escaped;
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                    escaped += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    escaped += ' ';
+                } else {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        };
+        
+        file << "{\"queries\":[";
+        bool first = true;
+        for (const Record* record : snapshot()) {
+            file << (first ? "" : ",") << "\n{\"sql\":\"" << escape(record->sql) << "\""
+                 << ",\"calls\":" << record->calls.load()
+                 << ",\"rows\":" << record->rows.load()
+                 << ",\"total_ns\":" << record->totalNs.load()
+                 << ",\"p50_ns\":" << record->percentileNs(0.50)
+                 << ",\"p90_ns\":" << record->percentileNs(0.90)
+                 << ",\"p99_ns\":" << record->percentileNs(0.99)
+                 << ",\"max_ns\":" << record->maxNs.load()
+                 << ",\"fullscan_steps\":" << record->fullscanSteps.load()
+                 << ",\"sorts\":" << record->sorts.load()
+                 << ",\"vm_steps\":" << record->vmSteps.load()
+                 << ",\"histogram\":[";
+            
+            // Non-empty buckets only, as [upper bound ns, count]
+            bool firstBucket = true;
+            for (int i = 0; i < bucketCount; i++) {
+                uint64_t count = record->histogram[i].load();
+                if (count > 0) {
+                    file << (firstBucket ? "" : ",") << "[" << bucketLimit(i) << "," << count << "]";
+                    firstBucket = false;
+                }
+            }
+            file << "]}";
+            first = false;
+        }
+        file << "\n]}\n";
+        
+        return static_cast<bool>(file);
     }
     
-private:
-    void initializeTables() {
-        // Create users table
-        executeQuery("CREATE TABLE IF NOT EXISTS users ("
-                    "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                    "username TEXT UNIQUE NOT NULL,"
-                    "password TEXT NOT NULL,"
-                    "role TEXT NOT NULL,"
-                    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP)");
-        
-        // Create inventory table
-        executeQuery("CREATE TABLE IF NOT EXISTS inventory ("
-                    "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                    "name TEXT UNIQUE NOT NULL,"
-                    "price INTEGER NOT NULL,"
-                    "quantity INTEGER NOT NULL,"
-                    "category TEXT NOT NULL)");
-        
-        // Create sales table
-        executeQuery("CREATE TABLE IF NOT EXISTS sales ("
-                    "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                    "item_id INTEGER NOT NULL,"
-                    "quantity INTEGER NOT NULL,"
-                    "total_price INTEGER NOT NULL,"
-                    "user_id INTEGER NOT NULL,"
-                    "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,"
-                    "FOREIGN KEY (item_id) REFERENCES inventory(id),"
-                    "FOREIGN KEY (user_id) REFERENCES users(id))");
-        
-        // Insert default admin if not exists
-        executeQuery("INSERT OR IGNORE INTO users (username, password, role) VALUES ('admin', 'admin123', 'admin')");
-        
-        // Insert default inventory items if not exists
-        executeQuery("INSERT OR IGNORE INTO inventory (name, price, quantity, category) VALUES "
-                   "('Room', 1200, 10, 'accommodation'),"
-                   "('Pasta', 250, 50, 'food'),"
-                   "('Burger', 120, 50, 'food'),"
-                   "('Noodles', 140, 50, 'food'),"
-                   "('Shake', 120, 50, 'drink'),"
-                   "('Chicken Roll', 150, 50, 'food')");
+#ifndef _WIN32
+    // Write the JSON dump to path whenever the process receives SIGUSR1
+    static void dumpOnSignal(const std::string& path) {
+        static std::once_flag installed;
+        std::call_once(installed, [path] {
+            std::signal(SIGUSR1, &QueryStats::onDumpSignal);
+            
+            std::thread([path] {
+                while (true) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    if (dumpRequested) {
+                        dumpRequested = 0;
+                        writeJson(path);
+                    }
+                }
+            }).detach();
+        });
     }
+#endif
 };
 
-// Initialize static member
-Database* Database::instance = nullptr;
+std::atomic<bool> QueryStats::enabled(false);
+std::mutex QueryStats::registryMutex;
+#ifndef _WIN32
+volatile std::sig_atomic_t QueryStats::dumpRequested = 0;
+#endif
 
-// Helper function for string escaping to prevent SQL injection
-std::string sqlEscape(const std::string& input) {
-    std::string result = input;
-    size_t pos = 0;
-    while ((pos = result.find("'", pos)) != std::string::npos) {
-        result.replace(pos, 1, "''");
-        pos += 2;
-    }
-    return result;
-}
+template <typename Row, typename... Columns>
+class RowRange;
 
-// Item class (represents a product or service)
-class Item {
+// Prepared statement borrowed from a connection's statement cache.
+// The handle is reset and its bindings cleared when it goes out of scope,
+// so the same compiled statement can be reused by the next caller.
+// Only one Statement per query text should be alive at a time on a connection.
+// Statements on the shared writer connection also hold the writer lock.
+class Statement {
 private:
-    int id;
-    std::string name;
-    int price;
-    std::string category;
-
+    sqlite3_stmt* stmt;
+    int lastResult;
+    std::unique_lock<std::recursive_mutex> lock;
+    
+    // Statistics and trace span for the current execution, from the first
+    // step until it finishes or the statement is reset
+    QueryStats::Record* record;
+    QueryStats::Clock::time_point started;
+    uint64_t rowCount;
+    bool timing;
+    bool collecting;
+    
+    void reportError() const {
+        std::cerr << "SQL error: " << sqlite3_errmsg(sqlite3_db_handle(stmt)) << std::endl;
+    }
+    
+    void finishTiming() {
+        if (!timing) {
+            return;
+        }
+        timing = false;
+        
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(QueryStats::Clock::now() - started);
+        if (Tracer::enabled()) {
+            Tracer::record({"statement", "sql", sqlite3_sql(stmt), started, elapsed});
+        }
+        if (!collecting) {
+            return;
+        }
+        
+        record->add(elapsed.count(), rowCount);
+        record->fullscanSteps.fetch_add(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1), std::memory_order_relaxed);
+        record->sorts.fetch_add(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1), std::memory_order_relaxed);
+        record->vmSteps.fetch_add(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1), std::memory_order_relaxed);
+    }
+    
 public:
-    Item(int id, const std::string& name, int price, const std::string& category) 
-        : id(id), name(name), price(price), category(category) {}
+    explicit Statement(sqlite3_stmt* stmt, std::unique_lock<std::recursive_mutex> lock = {},
+                       QueryStats::Record* record = nullptr)
+        : stmt(stmt), lastResult(SQLITE_OK), lock(std::move(lock)),
+          record(record), rowCount(0), timing(false), collecting(false) {}
     
-    int getId() const { return id; }
-    std::string getName() const { return name; }
-    int getPrice() const { return price; }
-    std::string getCategory() const { return category; }
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+    
+    Statement(Statement&& other) noexcept
+        : stmt(other.stmt), lastResult(other.lastResult), lock(std::move(other.lock)),
+          record(other.record), started(other.started), rowCount(other.rowCount),
+          timing(other.timing), collecting(other.collecting) {
+        other.stmt = nullptr;
+        other.timing = false;
+    }
+    
+    ~Statement() {
+        if (stmt) {
+            finishTiming();
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+    
+    bool isValid() const { return stmt != nullptr; }
+    int resultCode() const { return lastResult; }
+    
+    // Bind parameters (indexes start at 1, as in SQLite)
+    Statement& bind(int index, int value) {
+        if (stmt) sqlite3_bind_int(stmt, index, value);
+        return *this;
+    }
+    
+    Statement& bind(int index, long long value) {
+        if (stmt) sqlite3_bind_int64(stmt, index, value);
+        return *this;
+    }
+    
+    Statement& bind(int index, const std::string& value) {
+        if (stmt) sqlite3_bind_text(stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+        return *this;
+    }
+    
+    Statement& bindNull(int index) {
+        if (stmt) sqlite3_bind_null(stmt, index);
+        return *this;
+    }
+    
+    // Advance to the next row; returns false when there are no more rows or on error
+    bool step() {
+        if (!stmt) return false;
+        
+        if (!timing && ((record && QueryStats::isEnabled()) || Tracer::enabled())) {
+            collecting = record && QueryStats::isEnabled();
+            if (collecting) {
+                // Drop counts left over from executions that were not timed
+                sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+                sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+                sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1);
+            }
+            
+            timing = true;
+            rowCount = 0;
+            started = QueryStats::Clock::now();
+        }
+        
+        lastResult = sqlite3_step(stmt);
+        if (lastResult == SQLITE_ROW) {
+            rowCount++;
+            return true;
+        }
+        finishTiming();
+        if (lastResult != SQLITE_DONE) {
+            reportError();
+        }
+        return false;
+    }
+    
+    // Run a statement that returns no rows
+    bool execute() {
+        step();
+        return lastResult == SQLITE_DONE;
+    }
+    
+    void reset() {
+        if (stmt) {
+            finishTiming();
+            sqlite3_reset(stmt);
+        }
+    }
+    
+    int getInt(int column) const { return sqlite3_column_int(stmt, column); }
+    long long getInt64(int column) const { return sqlite3_column_int64(stmt, column); }
+    
+    std::string getText(int column) const {
+        const unsigned char* text = sqlite3_column_text(stmt, column);
+        return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+    }
+    
+    // Text of the current row without copying; valid until the next step()
+    std::string_view getView(int column) const {
+        const unsigned char* text = sqlite3_column_text(stmt, column);
+        return text ? std::string_view(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, column))
+                    : std::string_view();
+    }
+    
+    // Column as int, long long, double, std::string or std::string_view
+    template <typename T>
+    T get(int column) const {
+        if constexpr (std::is_same<T, int>::value) {
+            return getInt(column);
+        } else if constexpr (std::is_same<T, long long>::value) {
+            return getInt64(column);
+        } else if constexpr (std::is_same<T, double>::value) {
+            return sqlite3_column_double(stmt, column);
+        } else if constexpr (std::is_same<T, std::string_view>::value) {
+            return getView(column);
+        } else {
+            static_assert(std::is_same<T, std::string>::value, "unsupported column type");
+            return getText(column);
+        }
+    }
+    
+    // The remaining rows, stepped one at a time as the loop advances:
+    //   for (auto [name, quantity] : stmt.rows<std::string_view, int>()) ...
+    template <typename... Columns>
+    RowRange<std::tuple<Columns...>, Columns...> rows() {
+        return RowRange<std::tuple<Columns...>, Columns...>(*this);
+    }
+    
+    // Same, with each row built as Row{column 0, column 1, ...}
+    template <typename Row, typename... Columns>
+    RowRange<Row, Columns...> rowsAs() {
+        return RowRange<Row, Columns...>(*this);
+    }
 };
 
-// InventoryManager class
-class InventoryManager {
+// Input range over a statement's rows. Each row is read straight from the
+// current SQLite row when dereferenced, so iterating keeps one row in memory
+// however large the result is; string_view columns go stale on the next row.
+template <typename Row, typename... Columns>
+class RowRange {
+private:
+    Statement* stmt;
+    
 public:
-    static std::vector<Item> getAllItems() {
-        std::vector<Item> items;
+    explicit RowRange(Statement& stmt) : stmt(&stmt) {}
+    
+    class iterator {
+    private:
+        Statement* stmt;  // nullptr once the rows are exhausted
         
-        Database::getInstance().executeSelect(
-            "SELECT id, name, price, category FROM inventory ORDER BY category, name",
-            [&items](int argc, char** argv, char** azColName) {
-                if (argc >= 4) {
-                    int id = std::stoi(argv[0]);
-                    std::string name = argv[1];
-                    int price = std::stoi(argv[2]);
-                    std::string category = argv[3];
-                    
-                    items.emplace_back(id, name, price, category);
-                }
+        template <size_t... Index>
+        Row read(std::index_sequence<Index...>) const {
+            return Row{stmt->get<Columns>(static_cast<int>(Index))...};
+        }
+        
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Row;
+        
+        explicit iterator(Statement* stmt) : stmt(stmt && stmt->step() ? stmt : nullptr) {}
+        
+        Row operator*() const { return read(std::index_sequence_for<Columns...>()); }
+        
+        iterator& operator++() {
+            if (!stmt->step()) {
+                stmt = nullptr;
             }
-        );
+            return *this;
+        }
         
-        return items;
+        bool operator==(const iterator& other) const { return stmt == other.stmt; }
+        bool operator!=(const iterator& other) const { return stmt != other.stmt; }
+    };
+    
+    iterator begin() { return iterator(stmt); }
+    iterator end() { return iterator(nullptr); }
+};
+
+// One SQLite connection with its own statement cache.
+// A connection must only be used by one thread at a time.
+class Connection {
+private:
+    sqlite3* db;
+    
+    struct CachedStatement {
+        sqlite3_stmt* stmt;
+        QueryStats::Record* record;
+    };
+    
+    // Compiled statements keyed by their query text
+    std::unordered_map<std::string, CachedStatement> statementCache;
+    
+public:
+    Connection() : db(nullptr) {}
+    
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    
+    ~Connection() {
+        close();
     }
     
-    static Item getItemById(int id) {
-        Item item(0, "", 0, "");
+    bool open(const std::string& dbName, int busyTimeoutMs) {
+        close();
         
-        Database::getInstance().executeSelect(
-            "SELECT id, name, price, category FROM inventory WHERE id = " + std::to_string(id),
-            [&item](int argc, char** argv, char** azColName) {
-                if (argc >= 4) {
-                    int id = std::stoi(argv[0]);
-                    std::string name = argv[1];
-                    int price = std::stoi(argv[2]);
-                    std::string category = argv[3];
-                    
-                    item = Item(id, name, price, category);
-                }
-            }
-        );
+        // Connections are never shared between threads, so SQLite's own mutexes are not needed
+        int rc = sqlite3_open_v2(dbName.c_str(), &db,
+                                 SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (rc != SQLITE_OK) {
+            std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << std::endl;
+            close();
+            return false;
+        }
         
-        return item;
+        sqlite3_busy_timeout(db, busyTimeoutMs);
+        return true;
     }
     
-    static int getQuantity(int itemId) {
-        int quantity = 0;
+    sqlite3* handle() const { return db; }
+    
+    bool executeQuery(const std::string& query) {
+        TRACE_SPAN("executeQuery", "sql", query);
+        QueryStats::Record* record = QueryStats::isEnabled() ? QueryStats::recordFor(query) : nullptr;
+        auto started = record ? QueryStats::Clock::now() : QueryStats::Clock::time_point();
         
-        Database::getInstance().executeSelect(
-            "SELECT quantity FROM inventory WHERE id = " + std::to_string(itemId),
-            [&quantity](int argc, char** argv, char** azColName) {
-                if (argc >= 1) {
-                    quantity = std::stoi(argv[0]);
-                }
-            }
-        );
+        char* errMsg = nullptr;
+        int rc = sqlite3_exec(db, query.c_str(), nullptr, nullptr, &errMsg);
         
-        return quantity;
+        if (record) {
+            record->add(std::chrono::duration_cast<std::chrono::nanoseconds>(QueryStats::Clock::now() - started).count(), 0);
+        }
+        
+        if (rc != SQLITE_OK) {
+            std::cerr << "SQL error: " << errMsg << std::endl;
+            sqlite3_free(errMsg);
+            return false;
+        }
+        return true;
     }
     
-    static bool updateQuantity(int itemId, int newQuantity) {
-        std::string query = "UPDATE inventory SET quantity = " + 
-                          std::to_string(newQuantity) + 
-                          " WHERE id = " + std::to_string(itemId);
+    // Fetch a compiled statement from the cache, preparing it on first use
+    Statement prepare(const std::string& query, std::unique_lock<std::recursive_mutex> lock = {}) {
+        auto it = statementCache.find(query);
+        if (it != statementCache.end()) {
+            return Statement(it->second.stmt, std::move(lock), it->second.record);
+        }
+        
+        sqlite3_stmt* stmt = nullptr;
+        int rc = sqlite3_prepare_v3(db, query.c_str(), static_cast<int>(query.size()),
+                                    SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
         
-        return Database::getInstance().executeQuery(query);
+        if (rc != SQLITE_OK) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_finalize(stmt);
+            return Statement(nullptr);
+        }
+        
+        QueryStats::Record* record = QueryStats::recordFor(query);
+        statementCache.emplace(query, CachedStatement{stmt, record});
+        return Statement(stmt, std::move(lock), record);
     }
     
-    static bool decreaseQuantity(int itemId, int amount) {
-        int currentQty = getQuantity(itemId);
+    void close() {
+        for (auto& entry : statementCache) {
+            sqlite3_finalize(entry.second.stmt);
+        }
+        statementCache.clear();
         
-        if (currentQty >= amount) {
-            return updateQuantity(itemId, currentQty - amount);
+        if (db) {
+            sqlite3_close(db);
+            db = nullptr;
         }
+    }
+};
+
+// Storage tuning presets; each trades durability on power loss for commit speed:
+//   Durable   every commit is synced to disk before it returns (SQLite's defaults)
+//   Balanced  WAL syncs at checkpoints only, so a power cut may lose the last commits
+//             but never corrupts the file; larger page cache and memory-mapped reads
+//   Fast      no syncs at all; for benchmarks and scratch copies
+enum class StorageProfile { Durable, Balanced, Fast };
+
+static bool parseStorageProfile(const std::string& text, StorageProfile& profile) {
+    if (text == "durable") profile = StorageProfile::Durable;
+    else if (text == "balanced") profile = StorageProfile::Balanced;
+    else if (text == "fast") profile = StorageProfile::Fast;
+    else return false;
+    return true;
+}
+
+static const char* storageProfileName(StorageProfile profile) {
+    switch (profile) {
+        case StorageProfile::Balanced: return "balanced";
+        case StorageProfile::Fast: return "fast";
+        case StorageProfile::Durable:
+        default: return "durable";
+    }
+}
+
+// Connection settings chosen at Database::connect time
+struct DatabaseConfig {
+    StorageProfile profile = StorageProfile::Durable;
+    bool walMode = true;        // let readers run while an order is being written
+    int readerPoolSize = 4;     // idle reader connections kept for reuse (0 = read through the writer)
+    int busyTimeoutMs = 5000;   // how long a statement waits on a lock held by another process
+    int writeRetries = 3;       // extra BEGIN IMMEDIATE attempts once the busy timeout expires
+    int retryBackoffMs = 50;    // delay before the first retry, doubled on each attempt
+    bool queryStats = false;    // collect per-query latency statistics (see QueryStats)
+    int hotSalesDays = 90;      // days of sales kept in the sales table; older ones go to monthly archives (0 = keep all)
+    int archiveInterval = 600;  // seconds between archival runs in the server and the menu (0 = never)
+    int archiveBatchRows = 500; // sales moved per archive batch, so orders wait at most one batch
+};
+
+// Database singleton class
+// All writes go through one dedicated writer connection guarded by a lock.
+// Reads that can tolerate last-committed data use a per-thread reader
+// connection checked out from a pool, so reports do not queue behind orders.
+// With several properties each has its own Database, and getInstance()
+// returns the one the calling thread is routed to (see PropertyScope).
+class Database {
+private:
+    static Database* instance;
+    static thread_local Database* routed;
+    
+    std::string dbName;
+    DatabaseConfig config;
+    
+    Connection writer;
+    std::recursive_mutex writerMutex;
+    int transactionDepth = 0;  // open Transactions on the writer; guarded by writerMutex
+    
+    // Reader pool; a thread keeps its reader until it exits
+    std::vector<std::unique_ptr<Connection>> readers;
+    std::vector<Connection*> idleReaders;
+    std::mutex poolMutex;
+    std::atomic<int> poolGeneration;  // bumped by close() so threads drop stale readers
+    
+    struct ReaderSlot {
+        Database* owner = nullptr;
+        Connection* connection = nullptr;
+        int generation = -1;
         
-        return false;
+        ~ReaderSlot() {
+            if (connection) {
+                owner->releaseReader(connection, generation);
+            }
+        }
+    };
+    
+    // Manager state kept per database (see local()); slots are numbered per type
+    static const size_t maxLocals = 8;
+    std::once_flag localsCreated[maxLocals];
+    std::shared_ptr<void> locals[maxLocals];
+    
+    static size_t nextLocalSlot() {
+        static std::atomic<size_t> next(0);
+        return next++;
     }
+    
+public:
+    // Called with the table name whenever the writer changes a row
+    using ChangeListener = std::function<void(const std::string&)>;
+    
+private:
+    // Registered lazily by managers on any thread while others may be writing
+    std::vector<ChangeListener> changeListeners;
+    std::mutex listenersMutex;
+    
+    friend class Transaction;
+    friend class PropertyRouter;
+    
+    Database() : poolGeneration(0) {}
+    
+    static Database& defaultInstance() {
+        if (!instance) {
+            instance = new Database();
+        }
+        return *instance;
+    }
+    
+    static void onRowChange(void* data, int /*operation*/, const char* /*dbName*/, const char* table, sqlite3_int64 /*rowId*/) {
+        Database* self = static_cast<Database*>(data);
+        std::string tableName = table;
+        std::lock_guard<std::mutex> guard(self->listenersMutex);
+        for (auto& listener : self->changeListeners) {
+            listener(tableName);
+        }
+    }
+    
+    Connection* readerForThisThread() {
+        if (config.readerPoolSize <= 0) {
+            return nullptr;
+        }
+        
+        // One slot per database this thread has read from
+        thread_local std::unordered_map<Database*, ReaderSlot> slots;
+        ReaderSlot& slot = slots[this];
+        if (slot.connection && slot.generation == poolGeneration.load()) {
+            return slot.connection;
+        }
+        
+        std::lock_guard<std::mutex> guard(poolMutex);
+        slot.owner = this;
+        slot.connection = nullptr;
+        
+        if (!idleReaders.empty()) {
+            slot.connection = idleReaders.back();
+            idleReaders.pop_back();
+        } else {
+            auto conn = std::make_unique<Connection>();
+            if (!conn->open(dbName, config.busyTimeoutMs)) {
+                return nullptr;
+            }
+            conn->executeQuery("PRAGMA query_only = 1");
+            conn->executeQuery(profilePragmas(config.profile));
+            
+            slot.connection = conn.get();
+            readers.push_back(std::move(conn));
+        }
+        
+        slot.generation = poolGeneration.load();
+        return slot.connection;
+    }
+    
+    void releaseReader(Connection* conn, int generation) {
+        std::lock_guard<std::mutex> guard(poolMutex);
+        
+        if (generation != poolGeneration.load()) {
+            return;  // Already closed with the rest of the pool
+        }
+        
+        if (static_cast<int>(idleReaders.size()) < config.readerPoolSize) {
+            idleReaders.push_back(conn);
+            return;
+        }
+        
+        for (auto it = readers.begin(); it != readers.end(); ++it) {
+            if (it->get() == conn) {
+                readers.erase(it);
+                break;
+            }
+        }
+    }
+    
+    // BEGIN IMMEDIATE on the writer, retrying with backoff while another process holds the lock.
+    // The caller must hold writerMutex.
+    bool beginWrite() {
+        TRACE_SPAN("BEGIN IMMEDIATE", "sql");
+        
+        int delayMs = config.retryBackoffMs;
+        
+        for (int attempt = 0; ; attempt++) {
+            int rc = sqlite3_exec(writer.handle(), "BEGIN IMMEDIATE", nullptr, nullptr, nullptr);
+            
+            if (rc == SQLITE_OK) {
+                return true;
+            }
+            if ((rc != SQLITE_BUSY && rc != SQLITE_LOCKED) || attempt >= config.writeRetries) {
+                std::cerr << "SQL error: " << sqlite3_errmsg(writer.handle()) << std::endl;
+                return false;
+            }
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            delayMs *= 2;
+        }
+    }
+    
+public:
+    static Database& getInstance() {
+        if (routed) {
+            return *routed;
+        }
+        return defaultInstance();
+    }
+    
+    // Send this thread's getInstance() calls to db, or back to the default
+    // database for nullptr; returns the previous route
+    static Database* route(Database* db) {
+        Database* previous = routed;
+        routed = db;
+        return previous;
+    }
+    
+    const std::string& getName() const { return dbName; }
+    const DatabaseConfig& getConfig() const { return config; }
+    
+    // Another database file attached under schema to the connection that
+    // prepareRead() uses on this thread, until the object goes out of scope.
+    // Reads through the writer keep it locked meanwhile.
+    class Attachment {
+    private:
+        Connection* conn;
+        std::unique_lock<std::recursive_mutex> lock;
+        std::string schema;
+        
+    public:
+        Attachment(Database& db, const std::string& path, const std::string& schema)
+            : conn(db.readerForThisThread()), schema(schema) {
+            if (!conn) {
+                lock = std::unique_lock<std::recursive_mutex>(db.writerMutex);
+                conn = &db.writer;
+            }
+            
+            Statement stmt = conn->prepare("ATTACH DATABASE ? AS " + schema);
+            stmt.bind(1, path);
+            if (!stmt.execute()) {
+                std::cerr << "Cannot attach " << path << ": " << sqlite3_errmsg(conn->handle()) << std::endl;
+                conn = nullptr;
+            }
+        }
+        
+        Attachment(const Attachment&) = delete;
+        Attachment& operator=(const Attachment&) = delete;
+        
+        ~Attachment() {
+            if (conn) {
+                conn->executeQuery("DETACH DATABASE " + schema);
+            }
+        }
+        
+        bool isAttached() const { return conn != nullptr; }
+    };
+    
+    // State a manager keeps for this database, such as a cache, created on first use
+    template <typename State>
+    State& local() {
+        static const size_t slot = nextLocalSlot();
+        std::call_once(localsCreated[slot], [this] { locals[slot] = std::make_shared<State>(); });
+        return *static_cast<State*>(locals[slot].get());
+    }
+    
+    bool connect(const std::string& name = "hotel.db", const DatabaseConfig& settings = DatabaseConfig()) {
+        std::lock_guard<std::recursive_mutex> guard(writerMutex);
+        
+        dbName = name;
+        config = settings;
+        
+        if (!writer.open(dbName, config.busyTimeoutMs)) {
+            return false;
+        }
+        
+        sqlite3_update_hook(writer.handle(), &Database::onRowChange, this);
+        
+        if (config.queryStats) {
+            QueryStats::setEnabled(true);
+        }
+        
+        // Journal mode is not part of the profile: the reader pool relies on WAL
+        if (config.walMode) {
+            writer.executeQuery("PRAGMA journal_mode = WAL");
+        }
+        if (!writer.executeQuery(profilePragmas(config.profile))) {
+            std::cerr << "Warning: " << dbName << " runs without the " << storageProfileName(config.profile)
+                      << " storage profile settings" << std::endl;
+        }
+        
+        return initializeSchema();
+    }
+    
+    bool executeQuery(const std::string& query) {
+        std::lock_guard<std::recursive_mutex> guard(writerMutex);
+        return writer.executeQuery(query);
+    }
+    
+    // Not under the writer lock: a manager registers inside call_once, which a
+    // thread holding the writer may be waiting on
+    void addChangeListener(ChangeListener listener) {
+        std::lock_guard<std::mutex> guard(listenersMutex);
+        changeListeners.push_back(std::move(listener));
+    }
+    
+    // Changes whenever another connection commits to the database file
+    int dataVersion() {
+        Statement stmt = prepare("PRAGMA data_version");
+        return stmt.step() ? stmt.getInt(0) : 0;
+    }
+    
+    // dataVersion() without waiting: false while another thread holds the writer
+    bool peekDataVersion(int& version) {
+        std::unique_lock<std::recursive_mutex> lock(writerMutex, std::try_to_lock);
+        if (!lock) {
+            return false;
+        }
+        Statement stmt = writer.prepare("PRAGMA data_version", std::move(lock));
+        if (!stmt.step()) {
+            return false;
+        }
+        version = stmt.getInt(0);
+        return true;
+    }
+    
+    // Hold the writer lock across several statements without starting a transaction
+    std::unique_lock<std::recursive_mutex> lockWriter() {
+        return std::unique_lock<std::recursive_mutex>(writerMutex);
+    }
+    
+    // Statement on the writer connection; holds the writer lock while alive
+    Statement prepare(const std::string& query) {
+        std::unique_lock<std::recursive_mutex> lock(writerMutex);
+        return writer.prepare(query, std::move(lock));
+    }
+    
+    // Statement on this thread's reader connection. Sees committed data only,
+    // so use prepare() for reads that must see the current write transaction.
+    Statement prepareRead(const std::string& query) {
+        Connection* conn = readerForThisThread();
+        if (!conn) {
+            return prepare(query);
+        }
+        return conn->prepare(query);
+    }
+    
+    // Close every connection; worker threads must have stopped using the database
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(poolMutex);
+            poolGeneration++;
+            idleReaders.clear();
+            readers.clear();
+        }
+        
+        std::lock_guard<std::recursive_mutex> guard(writerMutex);
+        writer.close();
+    }
+    
+    ~Database() {
+        close();
+    }
+    
+private:
+    // Schema version this build expects, kept in PRAGMA user_version. Add a
+    // migration to initializeSchema() and bump it to change the schema.
+    static const int schemaVersion = 1;
+    
+    int userVersion() {
+        Statement stmt = prepare("PRAGMA user_version");
+        return stmt.step() ? stmt.getInt(0) : -1;
+    }
+    
+    // Bring the database up to schemaVersion in one write transaction. A
+    // current database costs a single PRAGMA read, with no writes or syncs.
+    bool initializeSchema() {
+        int version = userVersion();
+        if (version == schemaVersion) {
+            return true;
+        }
+        
+        if (!beginWrite()) {
+            return false;
+        }
+        
+        // Another process may have migrated while we waited for the lock
+        version = userVersion();
+        bool ok = version >= 0 && version <= schemaVersion;
+        if (!ok) {
+            std::cerr << "Error: " << dbName << " has schema version " << version
+                      << ", newer than this program supports (" << schemaVersion << ")" << std::endl;
+        }
+        
+        if (ok && version < 1) {
+            ok = createSchema() && initializeDailySales();
+        }
+        if (ok && version < schemaVersion) {
+            ok = executeQuery("PRAGMA user_version = " + std::to_string(schemaVersion));
+        }
+        
+        executeQuery(ok ? "COMMIT" : "ROLLBACK");
+        return ok;
+    }
+    
+    // Migration 1: tables and seed data as they were before schema versions.
+    // Every statement is idempotent, so older unversioned databases pass through it too.
+    bool createSchema() {
+        return executeQuery("CREATE TABLE IF NOT EXISTS users ("
+                            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                            "username TEXT UNIQUE NOT NULL,"
+                            "password TEXT NOT NULL,"
+                            "role TEXT NOT NULL,"
+                            "created_at DATETIME DEFAULT CURRENT_TIMESTAMP)") &&
+               executeQuery("CREATE TABLE IF NOT EXISTS inventory ("
+                            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                            "name TEXT UNIQUE NOT NULL,"
+                            "price INTEGER NOT NULL,"
+                            "quantity INTEGER NOT NULL,"
+                            "category TEXT NOT NULL)") &&
+               executeQuery("CREATE TABLE IF NOT EXISTS sales ("
+                            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                            "item_id INTEGER NOT NULL,"
+                            "quantity INTEGER NOT NULL,"
+                            "total_price INTEGER NOT NULL,"
+                            "user_id INTEGER NOT NULL,"
+                            "timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,"
+                            "FOREIGN KEY (item_id) REFERENCES inventory(id),"
+                            "FOREIGN KEY (user_id) REFERENCES users(id))") &&
+               // Months of sales moved out of the sales table, each in its own file
+               // next to this database (see SalesArchive)
+               executeQuery("CREATE TABLE IF NOT EXISTS sales_archives ("
+                            "month TEXT PRIMARY KEY,"
+                            "file TEXT NOT NULL,"
+                            "rows INTEGER NOT NULL,"
+                            "max_id INTEGER NOT NULL)") &&
+               // Default admin and inventory items
+               executeQuery("INSERT OR IGNORE INTO users (username, password, role) VALUES ('admin', 'admin123', 'admin')") &&
+               executeQuery("INSERT OR IGNORE INTO inventory (name, price, quantity, category) VALUES "
+                            "('Room', 1200, 10, 'accommodation'),"
+                            "('Pasta', 250, 50, 'food'),"
+                            "('Burger', 120, 50, 'food'),"
+                            "('Noodles', 140, 50, 'food'),"
+                            "('Shake', 120, 50, 'drink'),"
+                            "('Chicken Roll', 150, 50, 'food')") &&
+               // Physical rooms of each accommodation item, and their bookings by night
+               executeQuery("CREATE TABLE IF NOT EXISTS rooms ("
+                            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                            "item_id INTEGER NOT NULL,"
+                            "number TEXT UNIQUE NOT NULL,"
+                            "FOREIGN KEY (item_id) REFERENCES inventory(id))") &&
+               executeQuery("CREATE TABLE IF NOT EXISTS reservations ("
+                            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                            "room_id INTEGER NOT NULL,"
+                            "user_id INTEGER NOT NULL,"
+                            "check_in TEXT NOT NULL,"
+                            "check_out TEXT NOT NULL,"
+                            "created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
+                            "FOREIGN KEY (room_id) REFERENCES rooms(id),"
+                            "FOREIGN KEY (user_id) REFERENCES users(id))") &&
+               executeQuery("CREATE INDEX IF NOT EXISTS reservations_check_out ON reservations (check_out)") &&
+               // First run: one room per unit of each accommodation item, numbered <item id>01, <item id>02, ...
+               executeQuery("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < 99) "
+                            "INSERT INTO rooms (item_id, number) "
+                            "SELECT i.id, CAST(i.id * 100 + n.x AS TEXT) FROM inventory i JOIN n ON n.x <= i.quantity "
+                            "WHERE i.category = 'accommodation' AND NOT EXISTS (SELECT 1 FROM rooms)");
+    }
+    
+    // Per-day, per-item totals kept up to date by a trigger on sales, so the
+    // daily report reads a handful of rows instead of scanning all history.
+    // Rows are never removed when sales rows are deleted or archived.
+    // Runs inside the bootstrap transaction, so two processes cannot both backfill.
+    bool initializeDailySales() {
+        bool exists = false;
+        {
+            Statement stmt = prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'daily_sales'");
+            exists = stmt.step();
+        }
+        
+        if (exists) {
+            return true;
+        }
+        
+        return executeQuery("CREATE TABLE daily_sales ("
+                            "day TEXT NOT NULL,"
+                            "item_id INTEGER NOT NULL,"
+                            "quantity INTEGER NOT NULL,"
+                            "revenue INTEGER NOT NULL,"
+                            "PRIMARY KEY (day, item_id)) WITHOUT ROWID") &&
+               executeQuery("CREATE TRIGGER sales_rollup AFTER INSERT ON sales BEGIN "
+                            "INSERT INTO daily_sales (day, item_id, quantity, revenue) "
+                            "VALUES (DATE(NEW.timestamp), NEW.item_id, NEW.quantity, NEW.total_price) "
+                            "ON CONFLICT (day, item_id) DO UPDATE SET "
+                            "quantity = quantity + excluded.quantity, "
+                            "revenue = revenue + excluded.revenue; "
+                            "END") &&
+               // One-time backfill from the existing sales history
+               executeQuery("INSERT INTO daily_sales (day, item_id, quantity, revenue) "
+                            "SELECT DATE(timestamp), item_id, SUM(quantity), SUM(total_price) "
+                            "FROM sales GROUP BY DATE(timestamp), item_id");
+    }
+    
+    // Per-connection PRAGMAs for a storage profile
+    static std::string profilePragmas(StorageProfile profile) {
+        switch (profile) {
+            case StorageProfile::Balanced:
+                return "PRAGMA synchronous = NORMAL; PRAGMA cache_size = -16384; "
+                       "PRAGMA mmap_size = 268435456; PRAGMA temp_store = MEMORY";
+            case StorageProfile::Fast:
+                return "PRAGMA synchronous = OFF; PRAGMA cache_size = -65536; "
+                       "PRAGMA mmap_size = 1073741824; PRAGMA temp_store = MEMORY";
+            case StorageProfile::Durable:
+            default:
+                return "PRAGMA synchronous = FULL; PRAGMA cache_size = -2000; "
+                       "PRAGMA mmap_size = 0; PRAGMA temp_store = DEFAULT";
+        }
+    }
+};
+
+// Initialize static member
+Database* Database::instance = nullptr;
+thread_local Database* Database::routed = nullptr;
+
+// Write transaction on the writer connection. Holds the writer lock for its
+// whole lifetime and rolls back on destruction unless commit() succeeded.
+// Opened while this thread already has one, it becomes a savepoint inside it:
+// commit() keeps its changes for the outer transaction to commit and
+// rollback() undoes only its own, so batches can group many operations.
+class Transaction {
+private:
+    Database& db;
+    std::unique_lock<std::recursive_mutex> lock;
+    std::string savepoint;  // empty for an outermost transaction
+    bool active;
+    
+    bool begin() {
+        if (db.transactionDepth > 0) {
+            savepoint = "nested" + std::to_string(db.transactionDepth);
+            if (!db.prepare("SAVEPOINT " + savepoint).execute()) {
+                return false;
+            }
+        } else if (!db.beginWrite()) {
+            return false;
+        }
+        
+        db.transactionDepth++;
+        return true;
+    }
+    
+    void end() {
+        active = false;
+        db.transactionDepth--;
+    }
+    
+    void undo() {
+        if (savepoint.empty()) {
+            db.prepare("ROLLBACK").execute();
+        } else {
+            db.prepare("ROLLBACK TO " + savepoint).execute();
+            db.prepare("RELEASE " + savepoint).execute();
+        }
+    }
+    
+public:
+    Transaction()
+        : db(Database::getInstance()), lock(db.writerMutex), active(begin()) {}
+    
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+    
+    ~Transaction() {
+        rollback();
+    }
+    
+    bool isActive() const { return active; }
+    
+    bool commit() {
+        TRACE_SPAN("COMMIT", "sql");
+        
+        if (!active) {
+            return false;
+        }
+        
+        end();
+        if (db.prepare(savepoint.empty() ? "COMMIT" : "RELEASE " + savepoint).execute()) {
+            return true;
+        }
+        
+        undo();
+        return false;
+    }
+    
+    void rollback() {
+        if (active) {
+            end();
+            undo();
+        }
+    }
+};
+
+// Fixed-capacity queue; push blocks while full so a busy server stops
+// reading from clients instead of buffering without limit
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+    
+    // Returns false once the queue is closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        
+        if (closed) {
+            return false;
+        }
+        
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+    
+    // Returns false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        
+        if (items.empty()) {
+            return false;
+        }
+        
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+    
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+// Fixed set of threads running queued tasks; submit() returns the task's future
+class TaskPool {
+private:
+    BoundedQueue<std::function<void()>> tasks;
+    std::vector<std::thread> threads;
+
+public:
+    explicit TaskPool(int size, size_t capacity = 256) : tasks(capacity) {
+        for (int i = 0; i < size; i++) {
+            threads.emplace_back([this] {
+                std::function<void()> task;
+                while (tasks.pop(task)) {
+                    task();
+                }
+            });
+        }
+    }
+    
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    
+    ~TaskPool() {
+        tasks.close();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    
+    template <typename Task>
+    auto submit(Task task) -> std::future<decltype(task())> {
+        auto packaged = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+        std::future<decltype(task())> result = packaged->get_future();
+        tasks.push([packaged] { (*packaged)(); });
+        return result;
+    }
+};
+
+// One hotel of a multi-property deployment, with its own database file
+struct Property {
+    int id;
+    std::string name;
+    std::string path;
+    Database* database;
+};
+
+// Routes this thread's database calls to one property while in scope
+class PropertyScope {
+private:
+    Database* previous;
+
+public:
+    explicit PropertyScope(Database* database) : previous(Database::route(database)) {}
+    ~PropertyScope() { Database::route(previous); }
+    
+    PropertyScope(const PropertyScope&) = delete;
+    PropertyScope& operator=(const PropertyScope&) = delete;
+};
+
+// PropertyRouter class
+// Properties are numbered from 1 in the order they are added; property 1 uses
+// the default database, so a single-property setup behaves exactly as before.
+// Every property has its own connections, locks and caches, and finding one by
+// id reads a fixed table without locking, so opening more properties does not
+// slow down orders at any of them. Cross-property work runs one task per
+// property on a shared pool and the results come back in property order.
+class PropertyRouter {
+public:
+    static const int maxProperties = 64;
+
+private:
+    static std::atomic<Property*> table[maxProperties + 1];
+    static std::atomic<int> propertyCount;
+    static std::mutex registryMutex;
+    static std::unique_ptr<TaskPool> pool;
+    static std::once_flag poolCreated;
+
+public:
+    // Open the property's database; returns its id, or 0 on failure
+    static int addProperty(const std::string& name, const std::string& path,
+                           const DatabaseConfig& config = DatabaseConfig()) {
+        std::lock_guard<std::mutex> guard(registryMutex);
+        
+        int id = propertyCount + 1;
+        if (id > maxProperties) {
+            std::cerr << "Error: At most " << maxProperties << " properties are supported!" << std::endl;
+            return 0;
+        }
+        
+        Database* database = id == 1 ? &Database::defaultInstance() : new Database();
+        if (!database->connect(path, config)) {
+            std::cerr << "Failed to open database " << path << " for " << name << "!" << std::endl;
+            if (id != 1) {
+                delete database;
+            }
+            return 0;
+        }
+        
+        // Properties stay registered until the process exits
+        table[id].store(new Property{id, name, path, database}, std::memory_order_release);
+        propertyCount.store(id, std::memory_order_release);
+        return id;
+    }
+    
+    static int count() {
+        return propertyCount.load(std::memory_order_acquire);
+    }
+    
+    // nullptr for an unknown id
+    static const Property* find(int id) {
+        if (id < 1 || id > maxProperties) {
+            return nullptr;
+        }
+        return table[id].load(std::memory_order_acquire);
+    }
+    
+    static Database* database(int id) {
+        const Property* property = find(id);
+        return property ? property->database : nullptr;
+    }
+    
+    static std::vector<const Property*> all() {
+        std::vector<const Property*> properties;
+        for (int id = 1; id <= count(); id++) {
+            properties.push_back(find(id));
+        }
+        return properties;
+    }
+    
+    // Run task for every property in parallel, each inside its own PropertyScope
+    template <typename Result>
+    static std::vector<Result> fanOut(const std::function<Result(const Property&)>& task) {
+        TRACE_SPAN("PropertyRouter::fanOut", "property");
+        
+        std::call_once(poolCreated, [] {
+            pool = std::make_unique<TaskPool>(static_cast<int>(std::max(2u, std::thread::hardware_concurrency())));
+        });
+        
+        std::vector<std::future<Result>> pending;
+        for (const Property* property : all()) {
+            pending.push_back(pool->submit([property, &task] {
+                PropertyScope scope(property->database);
+                return task(*property);
+            }));
+        }
+        
+        std::vector<Result> results;
+        for (auto& result : pending) {
+            results.push_back(result.get());
+        }
+        return results;
+    }
+    
+    // Close every property's database; worker threads must have stopped using them
+    static void closeAll() {
+        pool.reset();
+        for (const Property* property : all()) {
+            property->database->close();
+        }
+    }
+};
+
+std::atomic<Property*> PropertyRouter::table[PropertyRouter::maxProperties + 1];
+std::atomic<int> PropertyRouter::propertyCount(0);
+std::mutex PropertyRouter::registryMutex;
+std::unique_ptr<TaskPool> PropertyRouter::pool;
+std::once_flag PropertyRouter::poolCreated;
+
+// Item class (represents a product or service)
+class Item {
+private:
+    int id;
+    std::string name;
+    int price;
+    std::string category;
+
+public:
+    Item(int id, const std::string& name, int price, const std::string& category) 
+        : id(id), name(name), price(price), category(category) {}
+    
+    int getId() const { return id; }
+    std::string getName() const { return name; }
+    int getPrice() const { return price; }
+    std::string getCategory() const { return category; }
+};
+
+// InventoryManager class
+class InventoryManager {
+public:
+    // Snapshot of the menu: items in menu order (category, name) and an id index
+    struct Catalog {
+        std::vector<Item> items;
+        std::unordered_map<int, size_t> index;
+    };
+    
+private:
+    // Shared snapshot, swapped whole when rebuilt so readers on other threads
+    // keep a consistent view. The mutex only guards the swap. One per database.
+    struct CatalogCache {
+        std::shared_ptr<const Catalog> catalog;
+        int dataVersion = 0;
+        std::mutex mutex;
+        std::atomic<bool> valid{false};
+    };
+    
+    static CatalogCache& cache() {
+        return Database::getInstance().local<CatalogCache>();
+    }
+    
+    static std::shared_ptr<const Catalog> loadCatalog() {
+        TRACE_SPAN("InventoryManager::loadCatalog", "inventory");
+        
+        auto fresh = std::make_shared<Catalog>();
+        
+        Statement stmt = Database::getInstance().prepare(
+            "SELECT id, name, price, category FROM inventory ORDER BY category, name");
+        
+        for (auto [id, name, price, category] : stmt.rows<int, std::string, int, std::string>()) {
+            fresh->index[id] = fresh->items.size();
+            fresh->items.emplace_back(id, name, price, category);
+        }
+        
+        return fresh;
+    }
+    
+public:
+    // Call after committing new items or changed names, prices or categories.
+    // Stock is not part of the catalog, so orders and restocks leave it alone.
+    static void invalidateCatalog() {
+        cache().valid = false;
+    }
+    
+    // Current menu snapshot, rebuilt first if it was invalidated or another
+    // process committed to the database file
+    static std::shared_ptr<const Catalog> getCatalog() {
+        TRACE_SPAN("InventoryManager::getCatalog", "inventory");
+        
+        CatalogCache& state = cache();
+        
+        // Not checked while another thread holds the writer, so a menu read
+        // never waits behind a write transaction; the next read checks again
+        int version = 0;
+        bool checked = Database::getInstance().peekDataVersion(version);
+        
+        {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            if (state.catalog && state.valid && (!checked || version == state.dataVersion)) {
+                return state.catalog;
+            }
+        }
+        
+        if (!checked) {
+            version = Database::getInstance().dataVersion();
+        }
+        
+        // Mark valid before loading so a write during the load invalidates it again
+        state.valid = true;
+        std::shared_ptr<const Catalog> fresh = loadCatalog();
+        
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.catalog = fresh;
+        state.dataVersion = version;
+        return fresh;
+    }
+    
+    static std::vector<Item> getAllItems() {
+        return getCatalog()->items;
+    }
+    
+    static Item getItemById(int id) {
+        std::shared_ptr<const Catalog> current = getCatalog();
+        
+        auto it = current->index.find(id);
+        if (it != current->index.end()) {
+            return current->items[it->second];
+        }
+        
+        return Item(0, "", 0, "");
+    }
+    
+    static int getQuantity(int itemId) {
+        TRACE_SPAN("InventoryManager::getQuantity", "inventory");
+        
+        int quantity = 0;
+        
+        Statement stmt = Database::getInstance().prepare(
+            "SELECT quantity FROM inventory WHERE id = ?");
+        stmt.bind(1, itemId);
+        
+        if (stmt.step()) {
+            quantity = stmt.getInt(0);
+        }
+        
+        return quantity;
+    }
+    
+    static bool updateQuantity(int itemId, int newQuantity) {
+        TRACE_SPAN("InventoryManager::updateQuantity", "inventory");
+        
+        Statement stmt = Database::getInstance().prepare(
+            "UPDATE inventory SET quantity = ? WHERE id = ?");
+        stmt.bind(1, newQuantity).bind(2, itemId);
+        
+        return stmt.execute();
+    }
+    
+    // Check and take stock in one guarded statement so two writers can never
+    // both pass the check. On success `item` holds the row that was reserved.
+    static bool reserveQuantity(int itemId, int amount, Item& item) {
+        TRACE_SPAN("InventoryManager::reserveQuantity", "inventory");
+        
+        Statement stmt = Database::getInstance().prepare(
+            "UPDATE inventory SET quantity = quantity - ? "
+            "WHERE id = ? AND quantity >= ? "
+            "RETURNING id, name, price, category");
+        stmt.bind(1, amount).bind(2, itemId).bind(3, amount);
+        
+        if (!stmt.step()) {
+            return false;
+        }
+        
+        item = Item(stmt.getInt(0), stmt.getText(1), stmt.getInt(2), stmt.getText(3));
+        
+        // Run the statement to completion so the write is finished before COMMIT
+        stmt.step();
+        return true;
+    }
+    
+    static bool decreaseQuantity(int itemId, int amount) {
+        Item item(0, "", 0, "");
+        return reserveQuantity(itemId, amount, item);
+    }
+};
+
+// Counts reported by an inventory import
+struct ImportCounts {
+    long inserted = 0;
+    long updated = 0;
+    long rejected = 0;
+};
+
+// InventoryImporter class
+// Loads a supplier catalog into inventory from a CSV file whose header names
+// the columns (name, price, category and optionally quantity, in any order),
+// or from JSON objects with the same keys, in an array or one per line.
+// Records are streamed and upserted by name through one prepared statement
+// inside one transaction; an existing item keeps its quantity when the record
+// has none. Invalid records are rejected with their line number and the rest
+// still load. The menu cache is invalidated once, after the commit.
+class InventoryImporter {
+private:
+    static const int reportedRejects = 10;
+    
+    // Field text by column name, for the record starting at line
+    using Record = std::unordered_map<std::string, std::string>;
+    
+    static void skipSpace(std::streambuf* in, int& line) {
+        for (int c = in->sgetc(); c == ' ' || c == '\t' || c == '\r' || c == '\n'; c = in->snextc()) {
+            line += c == '\n';
+        }
+    }
+    
+    // Next CSV record with RFC 4180 quoting; false at the end of the input
+    static bool readCsvRecord(std::streambuf* in, std::vector<std::string>& fields, int& line) {
+        fields.clear();
+        std::string field;
+        bool quoted = false;
+        
+        int c = in->sbumpc();
+        if (c == EOF) {
+            return false;
+        }
+        
+        for (; c != EOF; c = in->sbumpc()) {
+            if (quoted) {
+                if (c != '"') {
+                    line += c == '\n';
+                    field += static_cast<char>(c);
+                } else if (in->sgetc() == '"') {
+                    field += '"';
+                    in->sbumpc();
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.push_back(std::move(field));
+                field.clear();
+            } else if (c == '\n') {
+                line++;
+                break;
+            } else if (c != '\r') {
+                field += static_cast<char>(c);
+            }
+        }
+        
+        fields.push_back(std::move(field));
+        return true;
+    }
+    
+    static bool readJsonString(std::streambuf* in, std::string& text) {
+        text.clear();
+        for (int c = in->sbumpc(); c != EOF; c = in->sbumpc()) {
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                text += static_cast<char>(c);
+                continue;
+            }
+            
+            switch (c = in->sbumpc()) {
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'n': text += '\n'; break;
+                case 'r': text += '\r'; break;
+                case 't': text += '\t'; break;
+                case 'u': {
+                    char hex[5] = {};
+                    for (int i = 0; i < 4; i++) {
+                        hex[i] = static_cast<char>(in->sbumpc());
+                    }
+                    unsigned code = std::strtoul(hex, nullptr, 16);
+                    // Characters outside the BMP arrive as a surrogate pair
+                    if (code >= 0xD800 && code < 0xDC00 && in->sbumpc() == '\\' && in->sbumpc() == 'u') {
+                        for (int i = 0; i < 4; i++) {
+                            hex[i] = static_cast<char>(in->sbumpc());
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (std::strtoul(hex, nullptr, 16) - 0xDC00);
+                    }
+                    
+                    if (code < 0x80) {
+                        text += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        text += static_cast<char>(0xC0 | (code >> 6));
+                        text += static_cast<char>(0x80 | (code & 0x3F));
+                    } else if (code < 0x10000) {
+                        text += static_cast<char>(0xE0 | (code >> 12));
+                        text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        text += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        text += static_cast<char>(0xF0 | (code >> 18));
+                        text += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                        text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        text += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                case EOF: return false;
+                default: text += static_cast<char>(c); break;
+            }
+        }
+        return false;
+    }
+    
+    // Skip the array brackets and commas between JSON objects; true when the
+    // next object starts, false at the end of the input or on anything else
+    static bool nextJsonObject(std::streambuf* in, int& line, bool& malformed) {
+        while (true) {
+            skipSpace(in, line);
+            int c = in->sgetc();
+            if (c == '{' || c == EOF) {
+                return c == '{';
+            }
+            if (c != '[' && c != ']' && c != ',') {
+                malformed = true;
+                return false;
+            }
+            in->sbumpc();
+        }
+    }
+    
+    // The flat JSON object starting here as field text, null fields left out;
+    // sets malformed and returns false on bad syntax
+    static bool readJsonObject(std::streambuf* in, Record& record, int& line, bool& malformed) {
+        record.clear();
+        in->sbumpc();
+        
+        std::string key, value;
+        while (true) {
+            skipSpace(in, line);
+            int c = in->sbumpc();
+            if (c == '}' && key.empty()) {
+                return true;
+            }
+            if (c != '"' || !readJsonString(in, key)) {
+                break;
+            }
+            
+            skipSpace(in, line);
+            if (in->sbumpc() != ':') {
+                break;
+            }
+            skipSpace(in, line);
+            
+            bool isNull = false;
+            if (in->sgetc() == '"') {
+                in->sbumpc();
+                if (!readJsonString(in, value)) {
+                    break;
+                }
+            } else {
+                value.clear();
+                for (c = in->sgetc(); c != EOF && c != ',' && c != '}' && !std::isspace(c); c = in->snextc()) {
+                    value += static_cast<char>(c);
+                }
+                if (value.empty() || value == "[" || value == "{") {
+                    break;
+                }
+                isNull = value == "null";
+            }
+            if (!isNull) {
+                record[key] = value;
+            }
+            
+            skipSpace(in, line);
+            c = in->sbumpc();
+            if (c == '}') {
+                return true;
+            }
+            if (c != ',') {
+                break;
+            }
+        }
+        
+        malformed = true;
+        return false;
+    }
+    
+    static bool parseCount(const std::string& text, long long& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size() && value >= 0;
+    }
+    
+    // Upsert one record; returns an empty string, or why it was rejected
+    static std::string upsert(Statement& stmt, const Record& record, long long& maxId, ImportCounts& counts) {
+        auto field = [&record](const char* name) {
+            auto it = record.find(name);
+            return it == record.end() ? std::string() : it->second;
+        };
+        
+        std::string name = field("name"), category = field("category"), quantityText = field("quantity");
+        long long price = 0, quantity = 0;
+        if (name.empty() || category.empty()) {
+            return "name and category are required";
+        }
+        if (!parseCount(field("price"), price) || price > std::numeric_limits<int>::max()) {
+            return "price must be a whole number of dollars";
+        }
+        if (!quantityText.empty() && (!parseCount(quantityText, quantity) || quantity > std::numeric_limits<int>::max())) {
+            return "quantity must be a whole number";
+        }
+        
+        stmt.bind(1, name).bind(2, price).bind(4, category);
+        if (quantityText.empty()) {
+            stmt.bindNull(3);
+        } else {
+            stmt.bind(3, quantity);
+        }
+        
+        bool stored = stmt.step();
+        long long id = stored ? stmt.getInt64(0) : 0;
+        stored = stored && !stmt.step() && stmt.resultCode() == SQLITE_DONE;
+        stmt.reset();
+        if (!stored) {
+            return "not stored";
+        }
+        
+        // AUTOINCREMENT ids only grow, so a new item has the highest id seen yet
+        if (id > maxId) {
+            maxId = id;
+            counts.inserted++;
+        } else {
+            counts.updated++;
+        }
+        return "";
+    }
+    
+public:
+    // Import a catalog from in; out gets the counts and the first few rejects.
+    // Returns false, having changed nothing, if the file cannot be read or stored.
+    static bool importCatalog(std::istream& in, ImportCounts& counts, std::ostream& out = std::cout) {
+        TRACE_SPAN("InventoryImporter::importCatalog", "inventory");
+        
+        auto started = std::chrono::steady_clock::now();
+        std::streambuf* buf = in.rdbuf();
+        int line = 1;
+        skipSpace(buf, line);
+        bool json = buf->sgetc() == '[' || buf->sgetc() == '{';
+        
+        std::vector<std::string> columns, fields;
+        if (!json) {
+            if (!readCsvRecord(buf, columns, line)) {
+                out << "\nImport failed: the file is empty." << std::endl;
+                return false;
+            }
+            for (std::string& column : columns) {
+                std::transform(column.begin(), column.end(), column.begin(), ::tolower);
+            }
+            if (std::find(columns.begin(), columns.end(), "name") == columns.end()) {
+                out << "\nImport failed: the CSV header must name the name, price and category columns." << std::endl;
+                return false;
+            }
+        }
+        
+        counts = ImportCounts();
+        Transaction txn;
+        if (!txn.isActive()) {
+            out << "\nDatabase is busy. Please try again." << std::endl;
+            return false;
+        }
+        
+        long long maxId = 0;
+        {
+            Statement stmt = Database::getInstance().prepare("SELECT MAX(id) FROM inventory");
+            if (stmt.step()) {
+                maxId = stmt.getInt64(0);
+            }
+        }
+        
+        Statement stmt = Database::getInstance().prepare(
+            "INSERT INTO inventory (name, price, quantity, category) VALUES (?1, ?2, COALESCE(?3, 0), ?4) "
+            "ON CONFLICT (name) DO UPDATE SET price = excluded.price, category = excluded.category, "
+            "quantity = COALESCE(?3, quantity) "
+            "RETURNING id");
+        
+        Record record;
+        bool malformed = false;
+        while (true) {
+            if (json && !nextJsonObject(buf, line, malformed)) {
+                break;
+            }
+            
+            int recordLine = line;
+            std::string problem;
+            
+            if (json) {
+                if (!readJsonObject(buf, record, line, malformed)) {
+                    break;
+                }
+            } else {
+                if (!readCsvRecord(buf, fields, line)) {
+                    break;
+                }
+                if (fields.size() == 1 && fields[0].empty()) {
+                    continue;  // blank line
+                }
+                
+                record.clear();
+                for (size_t i = 0; i < columns.size() && i < fields.size(); i++) {
+                    record[columns[i]] = std::move(fields[i]);
+                }
+                if (fields.size() != columns.size()) {
+                    problem = "expected " + std::to_string(columns.size()) + " fields";
+                }
+            }
+            
+            if (problem.empty()) {
+                problem = upsert(stmt, record, maxId, counts);
+            }
+            if (!problem.empty() && ++counts.rejected <= reportedRejects) {
+                out << "\nLine " << recordLine << " rejected: " << problem;
+            }
+        }
+        stmt.reset();
+        
+        if (malformed) {
+            out << "\nImport failed: malformed JSON near line " << line << ". Nothing was changed." << std::endl;
+            return false;
+        }
+        if (!txn.commit()) {
+            out << "\nImport failed: the changes could not be saved." << std::endl;
+            return false;
+        }
+        InventoryManager::invalidateCatalog();
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (counts.rejected > reportedRejects) {
+            out << "\n... and " << counts.rejected - reportedRejects << " more rejected";
+        }
+        out << "\nImported " << counts.inserted << " new items, updated " << counts.updated
+            << ", rejected " << counts.rejected << " in " << std::fixed << std::setprecision(2) << seconds << " s"
+            << std::endl;
+        return true;
+    }
+    
+    static bool importFile(const std::string& path, std::ostream& out = std::cout) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            out << "\nImport failed: cannot open " << path << std::endl;
+            return false;
+        }
+        
+        ImportCounts counts;
+        return importCatalog(file, counts, out);
+    }
+};
+
+// One line of a multi-item order
+struct OrderLine {
+    int itemId;
+    int quantity;
+};
+
+// OrderManager class
+class OrderManager {
+public:
+    static bool processOrder(int itemId, int quantity, int userId, std::ostream& out = std::cout) {
+        TRACE_SPAN("OrderManager::processOrder", "order");
+        
+        // Take the write lock up front so the reservation and the sale
+        // are recorded together, even with several terminals on one database
+        Transaction txn;
+        if (!txn.isActive()) {
+            out << "\nDatabase is busy. Please try again." << std::endl;
+            return false;
+        }
+        
+        Item item(0, "", 0, "");
+        
+        if (!InventoryManager::reserveQuantity(itemId, quantity, item)) {
+            int currentQty = InventoryManager::getQuantity(itemId);
+            txn.rollback();
+            
+            out << "\nNot enough inventory. Only " << currentQty << " available." << std::endl;
+            return false;
+        }
+        
+        int totalPrice = item.getPrice() * quantity;
+        
+        // Record sale, then commit or rollback
+        if (recordSale(itemId, quantity, totalPrice, userId) && txn.commit()) {
+            // Display order confirmation
+            out << "\n\n\t\t" << quantity << " " << item.getName();
+            
+            if (item.getCategory() == "accommodation") {
+                out << "(s) have been allotted to you";
+            } else {
+                out << " is the order!";
+            }
+            
+            // Show bill
+            out << "\n\n Bill details:";
+            out << "\n Item: " << item.getName();
+            out << "\n Quantity: " << quantity; 
+            out << "\n Price per item: $" << item.getPrice();
+            out << "\n Total: $" << totalPrice << std::endl;
+            
+            return true;
+        }
+        
+        return false;
+    }
+    
+    // Check out several lines in one transaction with a single commit.
+    // If any line cannot be filled the whole cart is rolled back.
+    static bool processCart(const std::vector<OrderLine>& lines, int userId, std::ostream& out = std::cout) {
+        TRACE_SPAN("OrderManager::processCart", "order");
+        
+        if (lines.empty()) {
+            out << "\nCart is empty!" << std::endl;
+            return false;
+        }
+        
+        Transaction txn;
+        if (!txn.isActive()) {
+            out << "\nDatabase is busy. Please try again." << std::endl;
+            return false;
+        }
+        
+        std::vector<Item> reserved;
+        reserved.reserve(lines.size());
+        
+        for (const OrderLine& line : lines) {
+            Item item(0, "", 0, "");
+            
+            if (line.quantity <= 0 || !InventoryManager::reserveQuantity(line.itemId, line.quantity, item)) {
+                // Report against the stock as it stood before this cart
+                txn.rollback();
+                Item wanted = InventoryManager::getItemById(line.itemId);
+                int currentQty = InventoryManager::getQuantity(line.itemId);
+                
+                out << "\nCannot fill " << line.quantity << " " << wanted.getName()
+                          << ". Only " << currentQty << " available. Order cancelled." << std::endl;
+                return false;
+            }
+            
+            if (!recordSale(line.itemId, line.quantity, item.getPrice() * line.quantity, userId)) {
+                return false;
+            }
+            
+            reserved.push_back(item);
+        }
+        
+        if (!txn.commit()) {
+            return false;
+        }
+        
+        // Show combined bill
+        int grandTotal = 0;
+        
+        out << "\n\n Bill details:";
+        out << "\n------------------------------------------------------";
+        out << "\nItem                 Quantity    Price       Total";
+        out << "\n------------------------------------------------------";
+        
+        for (size_t i = 0; i < lines.size(); i++) {
+            int lineTotal = reserved[i].getPrice() * lines[i].quantity;
+            grandTotal += lineTotal;
+            
+            out << "\n" << std::left << std::setw(20) << reserved[i].getName()
+                     << std::right << std::setw(9) << lines[i].quantity
+                     << std::setw(6) << "$" << std::left << std::setw(6) << reserved[i].getPrice()
+                     << std::right << "$" << lineTotal;
+        }
+        
+        out << "\n------------------------------------------------------";
+        out << "\n Total: $" << grandTotal << std::endl;
+        
+        return true;
+    }
+    
+private:
+    static bool recordSale(int itemId, int quantity, int totalPrice, int userId) {
+        TRACE_SPAN("OrderManager::recordSale", "order");
+        
+        Statement stmt = Database::getInstance().prepare(
+            "INSERT INTO sales (item_id, quantity, total_price, user_id) VALUES (?, ?, ?, ?)");
+        stmt.bind(1, itemId).bind(2, quantity).bind(3, totalPrice).bind(4, userId);
+        
+        return stmt.execute();
+    }
+};
+
+// Logged-in user; the role is resolved once at login and kept for the session.
+// Users belong to one property, and the session's requests go to its database.
+struct UserSession {
+    int userId = -1;
+    std::string username;
+    std::string role;
+    int propertyId = 1;
+    
+    bool isLoggedIn() const { return userId > 0; }
+    bool isAdmin() const { return role == "admin"; }
+};
+
+// UserManager class
+class UserManager {
+public:
+    struct Account {
+        int id;
+        std::string password;
+        std::string role;
+    };
+    
+    // Snapshot of the users table keyed by username
+    struct Directory {
+        std::unordered_map<std::string, Account> accounts;
+    };
+    
+private:
+    // Rebuilt and swapped the same way as the inventory catalog
+    struct DirectoryCache {
+        std::shared_ptr<const Directory> directory;
+        int dataVersion = 0;
+        std::mutex mutex;
+        std::atomic<bool> valid{false};
+        std::once_flag listening;
+    };
+    
+    static DirectoryCache& cache() {
+        return Database::getInstance().local<DirectoryCache>();
+    }
+    
+    static std::shared_ptr<const Directory> loadDirectory() {
+        TRACE_SPAN("UserManager::loadDirectory", "auth");
+        
+        auto fresh = std::make_shared<Directory>();
+        
+        Statement stmt = Database::getInstance().prepare("SELECT id, username, password, role FROM users");
+        
+        for (auto [id, username, password, role] : stmt.rows<int, std::string, std::string, std::string>()) {
+            fresh->accounts[username] = Account{id, password, role};
+        }
+        
+        return fresh;
+    }
+    
+public:
+    static void invalidateDirectory() {
+        cache().valid = false;
+    }
+    
+    // Current user snapshot, reloaded first if users rows changed
+    static std::shared_ptr<const Directory> getDirectory() {
+        DirectoryCache& state = cache();
+        std::call_once(state.listening, [&state] {
+            Database::getInstance().addChangeListener([&state](const std::string& table) {
+                if (table == "users") {
+                    state.valid = false;
+                }
+            });
+        });
+        
+        // As for the catalog, skipped rather than waiting behind a write
+        int version = 0;
+        bool checked = Database::getInstance().peekDataVersion(version);
+        
+        {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            if (state.directory && state.valid && (!checked || version == state.dataVersion)) {
+                return state.directory;
+            }
+        }
+        
+        if (!checked) {
+            version = Database::getInstance().dataVersion();
+        }
+        
+        state.valid = true;
+        std::shared_ptr<const Directory> fresh = loadDirectory();
+        
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.directory = fresh;
+        state.dataVersion = version;
+        return fresh;
+    }
+    
+    // Check credentials and resolve id and role in one lookup.
+    // Returns a session with userId -1 when the credentials do not match.
+    static UserSession login(const std::string& username, const std::string& password) {
+        TRACE_SPAN("UserManager::login", "auth");
+        
+        UserSession session;
+        std::shared_ptr<const Directory> users = getDirectory();
+        
+        auto it = users->accounts.find(username);
+        if (it != users->accounts.end() && it->second.password == password) {
+            session.userId = it->second.id;
+            session.username = username;
+            session.role = it->second.role;
+        }
+        
+        return session;
+    }
+    
+    static int authenticateUser(const std::string& username, const std::string& password) {
+        return login(username, password).userId;
+    }
+    
+    static std::string getUserRole(int userId) {
+        std::shared_ptr<const Directory> users = getDirectory();
+        
+        for (const auto& entry : users->accounts) {
+            if (entry.second.id == userId) {
+                return entry.second.role;
+            }
+        }
+        
+        return "";
+    }
+    
+    static bool isValidRole(const std::string& role) {
+        return role == "admin" || role == "staff";
+    }
+    
+    // Fails for a taken username or a role other than admin or staff
+    static bool addUser(const std::string& username, const std::string& password, const std::string& role) {
+        if (!isValidRole(role)) {
+            return false;
+        }
+        
+        Statement stmt = Database::getInstance().prepare(
+            "INSERT INTO users (username, password, role) VALUES (?, ?, ?)");
+        stmt.bind(1, username).bind(2, password).bind(3, role);
+        
+        return stmt.execute();
+    }
+};
+
+// Calendar arithmetic on days since 1970-01-01 (proleptic Gregorian calendar)
+static int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void civilFromDays(int day, int& year, int& month, int& dayOfMonth) {
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int dayOfEra = day - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    dayOfMonth = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+// A confirmed (or proposed) stay in one room; check-out is the morning after the last night
+struct RoomBooking {
+    int reservationId = -1;
+    int roomId = -1;
+    std::string roomNumber;
+    std::string checkIn;
+    std::string checkOut;
+};
+
+// ReservationManager class
+// Every room has an occupancy bitset over a rolling horizon: bit d is set when
+// the night starting horizonStart + d is booked. Availability checks are word-wide
+// mask tests, so a search over thousands of rooms never touches the database.
+// Bookings are persisted in the reservations table and applied to the bitsets.
+class ReservationManager {
+public:
+    static const int horizonDays = 731;   // about two years from today
+    
+private:
+    static const int wordsPerRoom = (horizonDays + 63) / 64;
+    
+    struct RoomCalendar {
+        int roomId;
+        std::string number;
+        uint64_t nights[wordsPerRoom];
+    };
+    
+    // Rooms grouped by accommodation item, plus room id -> (item, position)
+    struct Calendar {
+        int horizonStart = 0;
+        std::unordered_map<int, std::vector<RoomCalendar>> byItem;
+        std::unordered_map<int, std::pair<int, size_t>> index;
+    };
+    
+    // Loaded with the writer lock held, so it cannot race with a booking from
+    // this process; the mutex guards reads and updates of the bits. One per database.
+    struct CalendarCache {
+        std::unique_ptr<Calendar> calendar;
+        int dataVersion = 0;
+        std::mutex mutex;
+    };
+    
+    static int today() {
+        time_t now = time(0);
+        tm* localTime = localtime(&now);
+        return daysFromCivil(localTime->tm_year + 1900, localTime->tm_mon + 1, localTime->tm_mday);
+    }
+    
+    // Mask of the bits of word w that fall inside nights [from, to)
+    static uint64_t rangeMask(int w, int from, int to) {
+        uint64_t mask = ~0ULL;
+        if (from > w * 64) {
+            mask &= ~0ULL << (from - w * 64);
+        }
+        if (to < (w + 1) * 64) {
+            mask &= (1ULL << (to - w * 64)) - 1;
+        }
+        return mask;
+    }
+    
+    static int highestBit(uint64_t word) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(word);
+#else
+        int bit = 63;
+        while (!(word >> bit)) {
+            bit--;
+        }
+        return bit;
+#endif
+    }
+    
+    // -1 if nights [from, to) are all free, otherwise the night after the last booked one
+    static int conflictEnd(const RoomCalendar& room, int from, int to) {
+        for (int w = (to - 1) / 64; w >= from / 64; w--) {
+            uint64_t booked = room.nights[w] & rangeMask(w, from, to);
+            if (booked) {
+                return w * 64 + highestBit(booked) + 1;
+            }
+        }
+        return -1;
+    }
+    
+    static void markRange(RoomCalendar& room, int from, int to, bool booked) {
+        for (int w = from / 64; w <= (to - 1) / 64; w++) {
+            if (booked) {
+                room.nights[w] |= rangeMask(w, from, to);
+            } else {
+                room.nights[w] &= ~rangeMask(w, from, to);
+            }
+        }
+    }
+    
+    static std::unique_ptr<Calendar> loadCalendar(int horizonStart) {
+        auto fresh = std::make_unique<Calendar>();
+        fresh->horizonStart = horizonStart;
+        
+        {
+            Statement stmt = Database::getInstance().prepare(
+                "SELECT id, item_id, number FROM rooms ORDER BY item_id, number");
+            
+            for (auto [roomId, itemId, number] : stmt.rows<int, int, std::string>()) {
+                std::vector<RoomCalendar>& rooms = fresh->byItem[itemId];
+                fresh->index[roomId] = std::make_pair(itemId, rooms.size());
+                rooms.push_back(RoomCalendar{roomId, number, {}});
+            }
+        }
+        
+        Statement stmt = Database::getInstance().prepare(
+            "SELECT room_id, check_in, check_out FROM reservations WHERE check_out > ?");
+        stmt.bind(1, formatDate(horizonStart));
+        
+        for (auto [roomId, checkInDate, checkOutDate] : stmt.rows<int, std::string, std::string>()) {
+            auto it = fresh->index.find(roomId);
+            int checkIn, checkOut;
+            if (it == fresh->index.end() || !parseDate(checkInDate, checkIn) || !parseDate(checkOutDate, checkOut)) {
+                continue;
+            }
+            
+            int from = std::max(checkIn - horizonStart, 0);
+            int to = std::min(checkOut - horizonStart, horizonDays);
+            if (from < to) {
+                markRange(fresh->byItem[it->second.first][it->second.second], from, to, true);
+            }
+        }
+        
+        return fresh;
+    }
+    
+    // This database's calendar, reloaded first when another process committed
+    // or the horizon moved to a new day. The caller must not hold its mutex.
+    static CalendarCache& refreshCalendar() {
+        TRACE_SPAN("ReservationManager::refreshCalendar", "rooms");
+        
+        CalendarCache& state = Database::getInstance().local<CalendarCache>();
+        std::unique_lock<std::recursive_mutex> writerLock = Database::getInstance().lockWriter();
+        int version = Database::getInstance().dataVersion();
+        int day = today();
+        
+        {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            if (state.calendar && state.calendar->horizonStart == day && state.dataVersion == version) {
+                return state;
+            }
+        }
+        
+        std::unique_ptr<Calendar> fresh = loadCalendar(day);
+        
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.calendar = std::move(fresh);
+        state.dataVersion = version;
+        return state;
+    }
+    
+    // Earliest free stay of the given length starting in [from, last]; the calendar's mutex must be held
+    static RoomCalendar* findRoom(Calendar& calendar, int itemId, int from, int last, int nights, int& start) {
+        auto it = calendar.byItem.find(itemId);
+        if (it == calendar.byItem.end()) {
+            return nullptr;
+        }
+        
+        RoomCalendar* best = nullptr;
+        for (RoomCalendar& room : it->second) {
+            int candidate = from;
+            int limit = best ? start - 1 : last;
+            
+            while (candidate <= limit) {
+                int blocked = conflictEnd(room, candidate, candidate + nights);
+                if (blocked < 0) {
+                    best = &room;
+                    start = candidate;
+                    break;
+                }
+                candidate = blocked;
+            }
+            
+            if (best && start == from) {
+                break;
+            }
+        }
+        
+        return best;
+    }
+    
+    // Convert a requested stay to horizon offsets; false if it is in the past or beyond the horizon
+    static bool toHorizon(const Calendar& calendar, const std::string& checkIn, int nights, int& from) {
+        int day;
+        if (nights < 1 || !parseDate(checkIn, day)) {
+            return false;
+        }
+        
+        from = day - calendar.horizonStart;
+        return from >= 0 && from + nights <= horizonDays;
+    }
+    
+    static RoomBooking describe(const RoomCalendar& room, int horizonStart, int from, int nights) {
+        RoomBooking booking;
+        booking.roomId = room.roomId;
+        booking.roomNumber = room.number;
+        booking.checkIn = formatDate(horizonStart + from);
+        booking.checkOut = formatDate(horizonStart + from + nights);
+        return booking;
+    }
+    
+public:
+    // Parse YYYY-MM-DD into days since 1970-01-01
+    static bool parseDate(const std::string& text, int& day) {
+        int year, month, dayOfMonth;
+        char extra;
+        if (std::sscanf(text.c_str(), "%4d-%2d-%2d%c", &year, &month, &dayOfMonth, &extra) != 3 ||
+            month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > 31) {
+            return false;
+        }
+        
+        day = daysFromCivil(year, month, dayOfMonth);
+        return formatDate(day) == text;  // rejects dates such as 2025-02-30
+    }
+    
+    static std::string formatDate(int day) {
+        int year, month, dayOfMonth;
+        civilFromDays(day, year, month, dayOfMonth);
+        
+        char text[32];
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, dayOfMonth);
+        return text;
+    }
+    
+    static std::string todayDate() {
+        return formatDate(today());
+    }
+    
+    // Drop this database's calendar so the next use reloads it. Call after
+    // rolling back a transaction that booked rooms inside a savepoint: those
+    // bookings were marked when the savepoint was released.
+    static void invalidateCalendar() {
+        CalendarCache& state = Database::getInstance().local<CalendarCache>();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.calendar.reset();
+    }
+    
+    // Number of rooms of an accommodation item free for every night of the stay
+    static int countAvailable(int itemId, const std::string& checkIn, int nights) {
+        TRACE_SPAN("ReservationManager::countAvailable", "rooms");
+        
+        CalendarCache& state = refreshCalendar();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        Calendar& calendar = *state.calendar;
+        
+        int from;
+        auto it = calendar.byItem.find(itemId);
+        if (!toHorizon(calendar, checkIn, nights, from) || it == calendar.byItem.end()) {
+            return 0;
+        }
+        
+        int count = 0;
+        for (const RoomCalendar& room : it->second) {
+            if (conflictEnd(room, from, from + nights) < 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+    
+    // Earliest stay of the given length that fits between earliest and
+    // earliest + windowDays, e.g. "3 nights in the next 60 days"
+    static bool findAvailable(int itemId, int nights, const std::string& earliest, int windowDays, RoomBooking& found) {
+        TRACE_SPAN("ReservationManager::findAvailable", "rooms");
+        
+        CalendarCache& state = refreshCalendar();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        Calendar& calendar = *state.calendar;
+        
+        int from;
+        if (!toHorizon(calendar, earliest, nights, from) || windowDays < nights) {
+            return false;
+        }
+        
+        int last = std::min(from + windowDays, horizonDays) - nights;
+        int start = 0;
+        const RoomCalendar* room = findRoom(calendar, itemId, from, last, nights, start);
+        
+        if (!room) {
+            return false;
+        }
+        found = describe(*room, calendar.horizonStart, start, nights);
+        return true;
+    }
+    
+    // Book any free room of the item for the stay and record the reservation
+    static bool bookRoom(int itemId, const std::string& checkIn, int nights, int userId,
+                         RoomBooking& booking, std::ostream& out = std::cout) {
+        TRACE_SPAN("ReservationManager::bookRoom", "rooms");
+        
+        // The transaction holds the writer lock, so bookings from this process run one at a time
+        Transaction txn;
+        if (!txn.isActive()) {
+            out << "\nBooking failed. Please try again.";
+            return false;
+        }
+        
+        CalendarCache& state = refreshCalendar();
+        
+        RoomCalendar* room = nullptr;
+        int from = 0;
+        {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            Calendar& calendar = *state.calendar;
+            
+            if (!toHorizon(calendar, checkIn, nights, from)) {
+                out << "\nInvalid stay. Check-in must be a date (YYYY-MM-DD) within the next "
+                    << horizonDays << " days.";
+                return false;
+            }
+            
+            int start = 0;
+            room = findRoom(calendar, itemId, from, from, nights, start);
+            if (room) {
+                // Claimed now so readers stop offering it; released again if the insert
+                // fails, and dropped with the calendar if an enclosing transaction rolls back
+                markRange(*room, from, from + nights, true);
+                booking = describe(*room, calendar.horizonStart, from, nights);
+            }
+        }
+        
+        if (!room) {
+            out << "\nNo room available for " << nights << " night(s) from " << checkIn << ".";
+            return false;
+        }
+        
+        Statement stmt = Database::getInstance().prepare(
+            "INSERT INTO reservations (room_id, user_id, check_in, check_out) VALUES (?, ?, ?, ?) RETURNING id");
+        stmt.bind(1, booking.roomId).bind(2, userId).bind(3, booking.checkIn).bind(4, booking.checkOut);
+        
+        if (stmt.step()) {
+            booking.reservationId = stmt.getInt(0);
+        }
+        bool inserted = booking.reservationId > 0 && !stmt.step() && stmt.resultCode() == SQLITE_DONE;
+        stmt.reset();
+        
+        if (!inserted || !txn.commit()) {
+            std::lock_guard<std::mutex> guard(state.mutex);
+            markRange(*room, from, from + nights, false);
+            out << "\nBooking failed. Please try again.";
+            return false;
+        }
+        
+        out << "\nReservation #" << booking.reservationId << ": room " << booking.roomNumber
+            << ", " << booking.checkIn << " to " << booking.checkOut
+            << " (" << nights << " night" << (nights == 1 ? "" : "s") << ")";
+        return true;
+    }
+};
+
+// SalesArchive class
+// The sales table keeps the last hotSalesDays days. Older sales move to one
+// database file per month next to the main one (hotel.sales-2025-01.db for
+// hotel.db), listed in sales_archives, a small batch at a time so an
+// order never waits behind more than one batch. Archive files are attached
+// only while they are read or written. daily_sales is left alone, so the
+// daily report and its history do not change when sales are archived.
+class SalesArchive {
+private:
+    // Archival holds the gate exclusively while it commits a batch and readers
+    // of several partitions hold it shared, so no read sees a row in both or neither
+    struct ArchiveState {
+        std::shared_mutex gate;
+        std::mutex running;  // one archival at a time
+    };
+    
+    static ArchiveState& state() {
+        return Database::getInstance().local<ArchiveState>();
+    }
+    
+    // Archive files sit in the main database's directory; only the file name is recorded
+    static std::string archivePath(const std::string& file) {
+        const std::string& dbName = Database::getInstance().getName();
+        size_t slash = dbName.find_last_of('/');
+        return slash == std::string::npos ? file : dbName.substr(0, slash + 1) + file;
+    }
+    
+    static std::string archiveFile(const std::string& month) {
+        std::string base = Database::getInstance().getName();
+        base = base.substr(base.find_last_of('/') + 1);
+        if (base.size() > 3 && base.compare(base.size() - 3, 3, ".db") == 0) {
+            base.erase(base.size() - 3);
+        }
+        return base + ".sales-" + month + ".db";
+    }
+    
+    // "YYYY-MM-01" of the month after "YYYY-MM"
+    static std::string nextMonth(const std::string& month) {
+        int year = std::atoi(month.substr(0, 4).c_str());
+        int monthOfYear = std::atoi(month.substr(5, 2).c_str());
+        return ReservationManager::formatDate(monthOfYear == 12 ? daysFromCivil(year + 1, 1, 1)
+                                                                : daysFromCivil(year, monthOfYear + 1, 1));
+    }
+    
+    // Move up to archiveBatchRows sales of month dated before cutoff into
+    // archive_out, which must be attached to the writer; returns the number moved.
+    // SQLite commits attached files one by one in WAL mode, so the copy is
+    // committed first and the sales are only deleted once it has succeeded; a
+    // crash in between leaves them in both files until the next run, which
+    // skips the copies already made and deletes them.
+    static int moveBatch(const std::string& month, const std::string& file, const std::string& cutoff) {
+        TRACE_SPAN("SalesArchive::moveBatch", "archive", month);
+        
+        Database& db = Database::getInstance();
+        std::string end = std::min(cutoff, nextMonth(month));
+        
+        std::unique_lock<std::shared_mutex> gate(state().gate);
+        Transaction copy;
+        if (!copy.isActive()) {
+            return 0;
+        }
+        
+        db.prepare("DELETE FROM temp.archive_batch").execute();
+        
+        // Sale ids follow time, so the batch comes from the lowest ids and only
+        // that many rows are read, however large the table is
+        Statement pick = db.prepare(
+            "INSERT INTO temp.archive_batch SELECT id FROM "
+            "(SELECT id, timestamp FROM main.sales ORDER BY id LIMIT ?) "
+            "WHERE timestamp >= ? AND timestamp < ?");
+        pick.bind(1, std::max(1, db.getConfig().archiveBatchRows)).bind(2, month + "-01").bind(3, end);
+        if (!pick.execute()) {
+            return 0;
+        }
+        
+        int moved = 0;
+        long long maxId = 0;
+        {
+            Statement stmt = db.prepare("SELECT COUNT(*), MAX(id) FROM temp.archive_batch");
+            if (stmt.step()) {
+                moved = stmt.getInt(0);
+                maxId = stmt.getInt64(1);
+            }
+        }
+        if (moved == 0) {
+            return 0;
+        }
+        
+        bool copied = db.prepare("INSERT OR IGNORE INTO archive_out.sales "
+                                 "(id, item_id, quantity, total_price, user_id, timestamp) "
+                                 "SELECT id, item_id, quantity, total_price, user_id, timestamp FROM main.sales "
+                                 "WHERE id IN (SELECT id FROM temp.archive_batch)").execute();
+        if (!copied || !copy.commit()) {
+            return 0;
+        }
+        
+        Transaction remove;
+        if (!remove.isActive()) {
+            return 0;
+        }
+        
+        Statement catalog = db.prepare(
+            "INSERT INTO sales_archives (month, file, rows, max_id) VALUES (?, ?, ?, ?) "
+            "ON CONFLICT (month) DO UPDATE SET rows = rows + excluded.rows, max_id = MAX(max_id, excluded.max_id)");
+        catalog.bind(1, month).bind(2, file).bind(3, moved).bind(4, maxId);
+        
+        bool ok = db.prepare("DELETE FROM main.sales WHERE id IN (SELECT id FROM temp.archive_batch)").execute() &&
+                  catalog.execute();
+        
+        return ok && remove.commit() ? moved : 0;
+    }
+    
+public:
+    // Move every sale older than hotSalesDays into its monthly archive;
+    // returns the number of sales moved
+    static long archiveOldSales(std::ostream& out = std::cout) {
+        TRACE_SPAN("SalesArchive::archiveOldSales", "archive");
+        
+        Database& db = Database::getInstance();
+        int hotDays = db.getConfig().hotSalesDays;
+        if (hotDays <= 0) {
+            return 0;
+        }
+        
+        std::lock_guard<std::mutex> running(state().running);
+        std::string cutoff = ReservationManager::formatDate(static_cast<int>(std::time(nullptr) / 86400) - hotDays + 1);
+        std::string attachedMonth;
+        long total = 0;
+        
+        db.executeQuery("CREATE TEMP TABLE IF NOT EXISTS archive_batch (id INTEGER PRIMARY KEY)");
+        
+        while (true) {
+            // Month of the oldest sale, if it is due. Sale ids follow time, so
+            // this reads one row, and off the writer so orders never wait for it.
+            std::string month;
+            {
+                Statement stmt = db.prepareRead("SELECT timestamp FROM sales ORDER BY id LIMIT 1");
+                std::string oldest = stmt.step() ? stmt.getText(0) : "";
+                if (oldest.size() < 7 || oldest >= cutoff) {
+                    break;
+                }
+                month = oldest.substr(0, 7);
+            }
+            
+            std::string file = archiveFile(month);
+            if (month != attachedMonth) {
+                if (!attachedMonth.empty()) {
+                    db.executeQuery("DETACH DATABASE archive_out");
+                    attachedMonth.clear();
+                }
+                
+                Statement attach = db.prepare("ATTACH DATABASE ? AS archive_out");
+                attach.bind(1, archivePath(file));
+                if (!attach.execute() ||
+                    !db.executeQuery("CREATE TABLE IF NOT EXISTS archive_out.sales ("
+                                     "id INTEGER PRIMARY KEY,"
+                                     "item_id INTEGER NOT NULL,"
+                                     "quantity INTEGER NOT NULL,"
+                                     "total_price INTEGER NOT NULL,"
+                                     "user_id INTEGER NOT NULL,"
+                                     "timestamp DATETIME)")) {
+                    std::cerr << "Error: Unable to open sales archive " << file << std::endl;
+                    break;
+                }
+                attachedMonth = month;
+            }
+            
+            int moved = moveBatch(month, file, cutoff);
+            if (moved == 0) {
+                break;
+            }
+            total += moved;
+            
+            // Let waiting orders take the writer between batches
+            std::this_thread::yield();
+        }
+        
+        if (!attachedMonth.empty()) {
+            db.executeQuery("DETACH DATABASE archive_out");
+        }
+        
+        if (total > 0) {
+            out << "\nMoved " << total << " sales older than " << hotDays << " days to monthly archives." << std::endl;
+        }
+        return total;
+    }
+    
+    // Archives every property's old sales on its own thread, once at start
+    // and then every intervalSeconds (never for 0), so the sales tables keep
+    // shrinking on a server nobody resets. Stops when destroyed, which must
+    // happen before the databases are closed. With no log the messages are dropped.
+    class Scheduler {
+    private:
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+        
+    public:
+        Scheduler(int intervalSeconds, std::ostream* log = nullptr) {
+            if (intervalSeconds <= 0) {
+                return;
+            }
+            
+            thread = std::thread([this, intervalSeconds, log] {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!stopping) {
+                    lock.unlock();
+                    for (const Property* property : PropertyRouter::all()) {
+                        PropertyScope scope(property->database);
+                        std::ostringstream messages;
+                        archiveOldSales(messages);
+                        if (log) {
+                            *log << messages.str() << std::flush;
+                        }
+                    }
+                    lock.lock();
+                    wake.wait_for(lock, std::chrono::seconds(intervalSeconds), [this] { return stopping; });
+                }
+            });
+        }
+        
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+        
+        ~Scheduler() {
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    };
+    
+    // The sales partitions covering archived months [fromMonth, toMonth]
+    // ("YYYY-MM") with ids above afterId. While it is alive archival waits, so
+    // every sale is in exactly one partition. Partition 0 is the hot sales
+    // table and the rest are archives, oldest first; each can be read from any
+    // thread, so one snapshot can be split across a pool.
+    class Partitions {
+    private:
+        std::shared_lock<std::shared_mutex> gate;
+        std::vector<std::string> files;
+        
+    public:
+        Partitions(const std::string& fromMonth, const std::string& toMonth, long long afterId = 0)
+            : gate(state().gate) {
+            Statement stmt = Database::getInstance().prepareRead(
+                "SELECT file FROM sales_archives WHERE month BETWEEN ? AND ? AND max_id > ? ORDER BY month");
+            stmt.bind(1, fromMonth).bind(2, toMonth).bind(3, afterId);
+            for (auto [file] : stmt.rows<std::string>()) {
+                files.push_back(file);
+            }
+        }
+        
+        size_t size() const { return files.size() + 1; }
+        
+        // Calls read("sales") or read("archive.sales") with partition i attached
+        // to the connection prepareRead() uses on this thread
+        bool read(size_t i, const std::function<void(const std::string&)>& read) const {
+            if (i == 0) {
+                read("sales");
+                return true;
+            }
+            
+            Database::Attachment archive(Database::getInstance(), archivePath(files[i - 1]), "archive");
+            if (!archive.isAttached()) {
+                return false;
+            }
+            read("archive.sales");
+            return true;
+        }
+    };
+    
+    // Calls read("sales") for the hot table, then read("archive.sales") for each
+    // archived month in [fromMonth, toMonth] ("YYYY-MM") holding ids above afterId,
+    // attached to the connection prepareRead() uses. read must select from the
+    // table it is given through prepareRead().
+    static bool forEachPartition(const std::string& fromMonth, const std::string& toMonth, long long afterId,
+                                 const std::function<void(const std::string&)>& read) {
+        TRACE_SPAN("SalesArchive::forEachPartition", "archive");
+        
+        Partitions partitions(fromMonth, toMonth, afterId);
+        for (size_t i = 0; i < partitions.size(); i++) {
+            if (!partitions.read(i, read)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Bucket sizes and groupings for revenue reports
+enum class TimeBucket { Hour, Day, Week, Month };
+enum class SalesDimension { Item, Category, User };
+
+// One line of a revenue report
+struct RevenueRow {
+    long long bucketStart;   // seconds since 1970-01-01 UTC
+    std::string key;         // item name, category or username
+    long long quantity;
+    long long revenue;
+};
+
+// SalesAnalytics class
+// The sales table mirrored column by column in memory and kept sorted by time,
+// so a revenue report over any range scans a few flat arrays instead of
+// running SQL. New sales are appended incrementally by id. Buckets that are
+// finished and fully inside a query range are cached per bucket size and
+// grouping, so a repeated report only aggregates the buckets still open.
+// Timestamps are UTC, as stored by CURRENT_TIMESTAMP.
+class SalesAnalytics {
+private:
+    struct Totals {
+        long long quantity = 0;
+        long long revenue = 0;
+    };
+    
+    // Totals per item id or user id within one bucket
+    using BucketTotals = std::unordered_map<int, Totals>;
+    
+    struct Columns {
+        std::vector<long long> epochs;
+        std::vector<int> itemIds;
+        std::vector<int> quantities;
+        std::vector<int> totalPrices;
+        std::vector<int> userIds;
+        long long lastSaleId = 0;
+        int maxItemId = 0;
+        int maxUserId = 0;
+    };
+    
+    // Below this many rows per thread a query is aggregated on the caller's thread
+    static const size_t minRowsPerThread = 100000;
+    
+    // One per database; the mutex is held for the whole of a query
+    struct AnalyticsCache {
+        Columns columns;
+    
+        // Keyed by (bucket size, grouped by user, bucket start); cachedThrough is
+        // the end of the latest cached bucket, so late rows before it clear the cache
+        std::map<std::tuple<int, bool, long long>, BucketTotals> bucketCache;
+        long long cachedThrough = 0;
+        std::mutex mutex;
+    };
+    
+    static AnalyticsCache& cache() {
+        return Database::getInstance().local<AnalyticsCache>();
+    }
+    
+    // "YYYY-MM-DD HH:MM:SS" to seconds since 1970-01-01
+    static long long parseTimestamp(std::string_view text) {
+        auto field = [&text](size_t pos, size_t length) {
+            int value = 0;
+            for (size_t i = pos; i < pos + length && i < text.size(); i++) {
+                value = value * 10 + (text[i] - '0');
+            }
+            return value;
+        };
+        
+        long long day = daysFromCivil(field(0, 4), field(5, 2), field(8, 2));
+        if (text.size() < 19) {
+            return day * 86400;
+        }
+        return day * 86400 + field(11, 2) * 3600 + field(14, 2) * 60 + field(17, 2);
+    }
+    
+    static long long bucketStart(TimeBucket size, long long epoch) {
+        long long day = epoch / 86400;
+        int year, month, dayOfMonth;
+        
+        switch (size) {
+            case TimeBucket::Hour:
+                return epoch / 3600 * 3600;
+            case TimeBucket::Day:
+                return day * 86400;
+            case TimeBucket::Week:
+                // Weeks start on Monday; 1970-01-01 was a Thursday
+                return (day - (day + 3) % 7) * 86400;
+            case TimeBucket::Month:
+            default:
+                civilFromDays(static_cast<int>(day), year, month, dayOfMonth);
+                return daysFromCivil(year, month, 1) * 86400LL;
+        }
+    }
+    
+    static long long bucketEnd(TimeBucket size, long long start) {
+        int year, month, dayOfMonth;
+        
+        switch (size) {
+            case TimeBucket::Hour:
+                return start + 3600;
+            case TimeBucket::Day:
+                return start + 86400;
+            case TimeBucket::Week:
+                return start + 7 * 86400;
+            case TimeBucket::Month:
+            default:
+                civilFromDays(static_cast<int>(start / 86400), year, month, dayOfMonth);
+                return (month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, month + 1, 1)) * 86400LL;
+        }
+    }
+    
+    // Append sales committed since the last query; the first load also reads
+    // the archived months, which only ever receive sales already loaded later on
+    static void loadNewSales(AnalyticsCache& state) {
+        TRACE_SPAN("SalesAnalytics::loadNewSales", "analytics");
+        
+        Columns& columns = state.columns;
+        long long afterId = columns.lastSaleId;
+        bool ordered = true;
+        long long earliestNew = std::numeric_limits<long long>::max();
+        
+        SalesArchive::forEachPartition("0000-00", "9999-99", afterId, [&](const std::string& table) {
+            Statement stmt = Database::getInstance().prepareRead(
+                "SELECT id, item_id, quantity, total_price, user_id, timestamp FROM " + table + " WHERE id > ? ORDER BY id");
+            stmt.bind(1, afterId);
+            
+            for (auto [id, itemId, quantity, totalPrice, userId, timestamp] :
+                 stmt.rows<long long, int, int, int, int, std::string_view>()) {
+                long long epoch = parseTimestamp(timestamp);
+                if (!columns.epochs.empty() && epoch < columns.epochs.back()) {
+                    ordered = false;
+                }
+                earliestNew = std::min(earliestNew, epoch);
+                
+                columns.lastSaleId = std::max(columns.lastSaleId, id);
+                columns.epochs.push_back(epoch);
+                columns.itemIds.push_back(itemId);
+                columns.quantities.push_back(quantity);
+                columns.totalPrices.push_back(totalPrice);
+                columns.userIds.push_back(userId);
+                columns.maxItemId = std::max(columns.maxItemId, itemId);
+                columns.maxUserId = std::max(columns.maxUserId, userId);
+            }
+        });
+        
+        if (!ordered) {
+            sortByTime(columns);
+        }
+        if (earliestNew < state.cachedThrough) {
+            state.bucketCache.clear();
+            state.cachedThrough = 0;
+        }
+    }
+    
+    // Only needed when sales arrive with timestamps older than rows already loaded
+    static void sortByTime(Columns& columns) {
+        std::vector<size_t> order(columns.epochs.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&columns](size_t a, size_t b) {
+            return columns.epochs[a] < columns.epochs[b];
+        });
+        
+        auto permute = [&order](auto& column) {
+            typename std::decay<decltype(column)>::type sorted(column.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                sorted[i] = column[order[i]];
+            }
+            column.swap(sorted);
+        };
+        
+        permute(columns.epochs);
+        permute(columns.itemIds);
+        permute(columns.quantities);
+        permute(columns.totalPrices);
+        permute(columns.userIds);
+    }
+    
+    static size_t firstRowAt(const Columns& columns, long long epoch) {
+        return std::lower_bound(columns.epochs.begin(), columns.epochs.end(), epoch) - columns.epochs.begin();
+    }
+    
+    // Rows [first, last) of one bucket that still have to be aggregated
+    struct PendingBucket {
+        long long start;
+        size_t first;
+        size_t last;
+        bool cacheable;
+    };
+    
+    // Aggregate the pending buckets, splitting their rows evenly across threads
+    static std::vector<BucketTotals> aggregate(const Columns& columns, const std::vector<PendingBucket>& pending, bool byUser) {
+        size_t totalRows = 0;
+        for (const PendingBucket& bucket : pending) {
+            totalRows += bucket.last - bucket.first;
+        }
+        
+        size_t threadCount = std::max<size_t>(1, std::min<size_t>(
+            std::max(1u, std::thread::hardware_concurrency()), totalRows / minRowsPerThread));
+        std::vector<std::vector<BucketTotals>> partial(threadCount, std::vector<BucketTotals>(pending.size()));
+        
+        const std::vector<int>& groups = byUser ? columns.userIds : columns.itemIds;
+        int maxGroup = byUser ? columns.maxUserId : columns.maxItemId;
+        
+        auto work = [&](size_t t) {
+            TRACE_SPAN("SalesAnalytics::aggregate", "analytics");
+            
+            size_t begin = totalRows * t / threadCount;
+            size_t end = totalRows * (t + 1) / threadCount;
+            
+            // Sum into a flat array, then keep only the groups that were touched
+            std::vector<Totals> scratch(maxGroup + 1);
+            std::vector<int> touched;
+            
+            size_t offset = 0;
+            for (size_t p = 0; p < pending.size() && offset < end; p++) {
+                size_t count = pending[p].last - pending[p].first;
+                size_t low = std::max(begin, offset);
+                size_t high = std::min(end, offset + count);
+                
+                for (size_t r = low; r < high; r++) {
+                    size_t row = pending[p].first + (r - offset);
+                    int group = groups[row];
+                    if (group < 0 || group > maxGroup) {
+                        continue;
+                    }
+                    
+                    Totals& totals = scratch[group];
+                    if (totals.quantity == 0 && totals.revenue == 0) {
+                        touched.push_back(group);
+                    }
+                    totals.quantity += columns.quantities[row];
+                    totals.revenue += columns.totalPrices[row];
+                }
+                
+                for (int group : touched) {
+                    partial[t][p][group] = scratch[group];
+                    scratch[group] = Totals();
+                }
+                touched.clear();
+                offset += count;
+            }
+        };
+        
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < threadCount; t++) {
+            threads.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        std::vector<BucketTotals> merged = std::move(partial[0]);
+        for (size_t t = 1; t < threadCount; t++) {
+            for (size_t p = 0; p < pending.size(); p++) {
+                for (const auto& entry : partial[t][p]) {
+                    Totals& totals = merged[p][entry.first];
+                    totals.quantity += entry.second.quantity;
+                    totals.revenue += entry.second.revenue;
+                }
+            }
+        }
+        return merged;
+    }
+    
+public:
+    static bool parseTimeBucket(const std::string& text, TimeBucket& size) {
+        if (text == "hour") size = TimeBucket::Hour;
+        else if (text == "day") size = TimeBucket::Day;
+        else if (text == "week") size = TimeBucket::Week;
+        else if (text == "month") size = TimeBucket::Month;
+        else return false;
+        return true;
+    }
+    
+    static bool parseDimension(const std::string& text, SalesDimension& dimension) {
+        if (text == "item") dimension = SalesDimension::Item;
+        else if (text == "category") dimension = SalesDimension::Category;
+        else if (text == "user") dimension = SalesDimension::User;
+        else return false;
+        return true;
+    }
+    
+    // Label of a bucket: "2025-03-14 09:00" for hours, the first day for days and weeks, "2025-03" for months
+    static std::string bucketLabel(TimeBucket size, long long start) {
+        int year, month, dayOfMonth;
+        civilFromDays(static_cast<int>(start / 86400), year, month, dayOfMonth);
+        
+        char label[32];
+        if (size == TimeBucket::Hour) {
+            std::snprintf(label, sizeof(label), "%04d-%02d-%02d %02d:00",
+                          year, month, dayOfMonth, static_cast<int>(start % 86400 / 3600));
+        } else if (size == TimeBucket::Month) {
+            std::snprintf(label, sizeof(label), "%04d-%02d", year, month);
+        } else {
+            std::snprintf(label, sizeof(label), "%04d-%02d-%02d", year, month, dayOfMonth);
+        }
+        return label;
+    }
+    
+    // Drop everything loaded so far, e.g. after sales rows were deleted
+    static void invalidate() {
+        AnalyticsCache& state = cache();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.columns = Columns();
+        state.bucketCache.clear();
+        state.cachedThrough = 0;
+    }
+    
+    // Quantity and revenue per bucket and group for sales in [from, to), in
+    // seconds since 1970-01-01 UTC. Rows are ordered by bucket, then by name.
+    static std::vector<RevenueRow> revenue(TimeBucket size, SalesDimension dimension, long long from, long long to) {
+        TRACE_SPAN("SalesAnalytics::revenue", "analytics");
+        
+        AnalyticsCache& state = cache();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        loadNewSales(state);
+        
+        const Columns& columns = state.columns;
+        auto& bucketCache = state.bucketCache;
+        
+        bool byUser = dimension == SalesDimension::User;
+        long long now = std::time(nullptr);
+        // Bucket start -> totals, pointing into the cache or into computed below
+        std::map<long long, const BucketTotals*> buckets;
+        std::vector<PendingBucket> pending;
+        
+        // Only walk the buckets that can hold data
+        if (!columns.epochs.empty()) {
+            long long first = std::max(from, columns.epochs.front());
+            long long last = std::min(to, columns.epochs.back() + 1);
+            
+            for (long long start = bucketStart(size, first); start < last; start = bucketEnd(size, start)) {
+                long long end = bucketEnd(size, start);
+                bool cacheable = start >= from && end <= to && end <= now;
+                
+                if (cacheable) {
+                    auto cached = bucketCache.find(std::make_tuple(static_cast<int>(size), byUser, start));
+                    if (cached != bucketCache.end()) {
+                        buckets[start] = &cached->second;
+                        continue;
+                    }
+                }
+                
+                size_t firstRow = firstRowAt(columns, std::max(start, from));
+                size_t lastRow = firstRowAt(columns, std::min(end, to));
+                if (firstRow < lastRow || cacheable) {
+                    pending.push_back({start, firstRow, lastRow, cacheable});
+                }
+            }
+        }
+        
+        std::vector<BucketTotals> computed = aggregate(columns, pending, byUser);
+        for (size_t p = 0; p < pending.size(); p++) {
+            const BucketTotals* totals = &computed[p];
+            if (pending[p].cacheable) {
+                BucketTotals& cached = bucketCache[std::make_tuple(static_cast<int>(size), byUser, pending[p].start)];
+                cached = std::move(computed[p]);
+                state.cachedThrough = std::max(state.cachedThrough, bucketEnd(size, pending[p].start));
+                totals = &cached;
+            }
+            buckets[pending[p].start] = totals;
+        }
+        
+        // Resolve ids to names; categories are rolled up from the item totals
+        std::shared_ptr<const InventoryManager::Catalog> catalog = InventoryManager::getCatalog();
+        std::unordered_map<int, std::string> userNames;
+        if (byUser) {
+            for (const auto& entry : UserManager::getDirectory()->accounts) {
+                userNames[entry.second.id] = entry.first;
+            }
+        }
+        
+        auto nameOf = [&](int id) {
+            if (byUser) {
+                auto it = userNames.find(id);
+                return it != userNames.end() ? it->second : "#" + std::to_string(id);
+            }
+            auto it = catalog->index.find(id);
+            if (it == catalog->index.end()) {
+                return "#" + std::to_string(id);
+            }
+            const Item& item = catalog->items[it->second];
+            return dimension == SalesDimension::Category ? item.getCategory() : item.getName();
+        };
+        
+        std::vector<RevenueRow> rows;
+        for (const auto& bucket : buckets) {
+            std::map<std::string, Totals> named;
+            for (const auto& entry : *bucket.second) {
+                Totals& totals = named[nameOf(entry.first)];
+                totals.quantity += entry.second.quantity;
+                totals.revenue += entry.second.revenue;
+            }
+            for (const auto& entry : named) {
+                rows.push_back({bucket.first, entry.first, entry.second.quantity, entry.second.revenue});
+            }
+        }
+        return rows;
+    }
+};
+
+// SalesExporter class
+// Writes the sales of a date range as CSV, from the sales table and the
+// monthly archives alike. Each partition is cut into ranges of sale ids that
+// a pool of threads reads and formats into buffers of their own; for .gz
+// output each buffer is also compressed into a separate gzip member, which
+// gunzip reads back as one stream. Buffers are written in id order in large
+// blocks, with only a few in flight, so memory stays flat for any range.
+class SalesExporter {
+public:
+    static const long long chunkIds = 65536;   // sale ids formatted per task
+    static const size_t writeBlock = 1 << 20;  // bytes per file write
+    static const unsigned maxThreads = 8;
+
+private:
+    struct Chunk {
+        size_t partition;
+        long long firstId;
+        long long lastId;
+    };
+    
+    static void appendNumber(std::string& text, long long value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, result.ptr);
+    }
+    
+    // Quoted only when it holds a comma, quote or line break
+    static void appendField(std::string& text, std::string_view field) {
+        if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+            text.append(field);
+            return;
+        }
+        
+        text += '"';
+        for (char c : field) {
+            if (c == '"') {
+                text += '"';
+            }
+            text += c;
+        }
+        text += '"';
+    }
+    
+    // What each unit was charged, to the cent when the total does not divide evenly
+    static void appendUnitPrice(std::string& text, long long totalPrice, long long quantity) {
+        if (quantity <= 0 || totalPrice % quantity == 0) {
+            appendNumber(text, quantity > 0 ? totalPrice / quantity : totalPrice);
+            return;
+        }
+        
+        long long cents = (totalPrice * 100 + quantity / 2) / quantity;
+        appendNumber(text, cents / 100);
+        text += cents % 100 < 10 ? ".0" : ".";
+        appendNumber(text, cents % 100);
+    }
+    
+    // Replace data with one complete gzip member holding it
+    static bool compress(std::string& data) {
+        z_stream stream{};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        
+        std::string packed(deflateBound(&stream, data.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(data.data());
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(packed.data());
+        stream.avail_out = static_cast<uInt>(packed.size());
+        
+        int status = deflate(&stream, Z_FINISH);
+        packed.resize(stream.total_out);
+        deflateEnd(&stream);
+        
+        if (status != Z_STREAM_END) {
+            return false;
+        }
+        data.swap(packed);
+        return true;
+    }
+    
+    // Lowest id in [low, high + 1] from which every sale in table is dated at
+    // or after date. Sale ids follow time, so a binary search over ids finds it
+    // in a few dozen indexed lookups, with no scan.
+    static long long firstIdFrom(const std::string& table, const std::string& date, long long low, long long high) {
+        Statement stmt = Database::getInstance().prepareRead(
+            "SELECT timestamp FROM " + table + " WHERE id >= ? ORDER BY id LIMIT 1");
+        
+        high++;
+        while (low < high) {
+            long long mid = low + (high - low) / 2;
+            stmt.bind(1, mid);
+            bool atOrAfter = !stmt.step() || stmt.getText(0) >= date;
+            stmt.reset();
+            
+            if (atOrAfter) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        return low;
+    }
+    
+    // Split the ids of table's sales dated in [from, to) into chunks
+    static void planChunks(const std::string& table, size_t partition, const std::string& from,
+                           const std::string& to, std::vector<Chunk>& chunks) {
+        long long firstId = 0, lastId = 0;
+        {
+            // Separate subqueries, so each is a single lookup at one end of the table
+            Statement stmt = Database::getInstance().prepareRead(
+                "SELECT (SELECT MIN(id) FROM " + table + "), (SELECT MAX(id) FROM " + table + ")");
+            if (stmt.step()) {
+                firstId = stmt.getInt64(0);
+                lastId = stmt.getInt64(1);
+            }
+        }
+        
+        if (lastId <= 0) {
+            return;
+        }
+        firstId = firstIdFrom(table, from, firstId, lastId);
+        lastId = firstIdFrom(table, to, firstId, lastId) - 1;
+        
+        for (long long id = firstId; id <= lastId; id += chunkIds) {
+            chunks.push_back({partition, id, std::min(lastId, id + chunkIds - 1)});
+        }
+    }
+    
+    // CSV lines for the sales of chunk dated in [from, to), in id order; the
+    // dates are checked again, as a chunk's ends were found assuming time order
+    static bool formatChunk(const SalesArchive::Partitions& partitions, const Chunk& chunk,
+                            const std::string& from, const std::string& to, std::string& text) {
+        TRACE_SPAN("SalesExporter::formatChunk", "report");
+        
+        return partitions.read(chunk.partition, [&](const std::string& table) {
+            Statement stmt = Database::getInstance().prepareRead(
+                "SELECT s.timestamp, i.name, i.category, s.quantity, s.total_price, u.username "
+                "FROM " + table + " s "
+                "JOIN inventory i ON s.item_id = i.id "
+                "JOIN users u ON s.user_id = u.id "
+                "WHERE s.id BETWEEN ? AND ? AND s.timestamp >= ? AND s.timestamp < ? "
+                "ORDER BY s.id");
+            stmt.bind(1, chunk.firstId).bind(2, chunk.lastId).bind(3, from).bind(4, to);
+            
+            for (auto [timestamp, name, category, quantity, totalPrice, username] :
+                 stmt.rows<std::string_view, std::string_view, std::string_view, long long, long long, std::string_view>()) {
+                appendField(text, timestamp);
+                text += ',';
+                appendField(text, name);
+                text += ',';
+                appendField(text, category);
+                text += ',';
+                appendNumber(text, quantity);
+                text += ',';
+                appendUnitPrice(text, totalPrice, quantity);
+                text += ',';
+                appendNumber(text, totalPrice);
+                text += ',';
+                appendField(text, username);
+                text += '\n';
+            }
+        });
+    }
+    
+    static bool writeAll(std::FILE* file, const std::string& data) {
+        return std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    }
+    
+public:
+    // Write the sales dated fromDay..toDay (days since 1970-01-01 UTC, inclusive)
+    // to filename, gzip-compressed when it ends in ".gz". The file appears only
+    // once it is complete.
+    static bool exportRange(int fromDay, int toDay, const std::string& filename, std::ostream& out = std::cout) {
+        TRACE_SPAN("SalesExporter::exportRange", "report");
+        
+        Database* db = &Database::getInstance();
+        bool gzip = filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+        std::string from = ReservationManager::formatDate(fromDay);
+        std::string to = ReservationManager::formatDate(toDay + 1);
+        
+        // Archives hold the older sales, so they are written before the sales table
+        SalesArchive::Partitions partitions(from.substr(0, 7), ReservationManager::formatDate(toDay).substr(0, 7));
+        std::vector<Chunk> chunks;
+        for (size_t i = 1; i <= partitions.size(); i++) {
+            size_t partition = i % partitions.size();
+            if (!partitions.read(partition, [&](const std::string& table) {
+                    planChunks(table, partition, from, to, chunks);
+                })) {
+                return false;
+            }
+        }
+        
+        std::string partial = filename + ".part";
+        std::FILE* file = std::fopen(partial.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Error: Unable to create report file!" << std::endl;
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IONBF, 0);  // every write is already a large block
+        
+        std::string pending = "Date,Item,Category,Quantity,Unit Price,Total Price,User\n";
+        bool ok = !gzip || compress(pending);
+        std::atomic<bool> failed{false};
+        
+        // Without a reader pool every read goes through the writer, one at a time
+        unsigned threads = db->getConfig().readerPoolSize > 0
+                               ? std::max(1u, std::min(maxThreads, std::thread::hardware_concurrency()))
+                               : 1;
+        {
+            TaskPool pool(static_cast<int>(threads));
+            std::deque<std::future<std::string>> inFlight;
+            size_t next = 0;
+            
+            while (ok && !failed && (next < chunks.size() || !inFlight.empty())) {
+                while (next < chunks.size() && inFlight.size() < 2 * threads) {
+                    Chunk chunk = chunks[next++];
+                    inFlight.push_back(pool.submit([&, db, chunk] {
+                        PropertyScope scope(db);
+                        std::string text;
+                        if (!formatChunk(partitions, chunk, from, to, text) || (gzip && !compress(text))) {
+                            failed = true;
+                        }
+                        return text;
+                    }));
+                }
+                
+                pending += inFlight.front().get();
+                inFlight.pop_front();
+                if (pending.size() >= writeBlock) {
+                    ok = writeAll(file, pending);
+                    pending.clear();
+                }
+            }
+        }
+        
+        ok = ok && !failed && writeAll(file, pending);
+        ok = std::fclose(file) == 0 && ok;
+        if (ok) {
+            std::remove(filename.c_str());
+            ok = std::rename(partial.c_str(), filename.c_str()) == 0;
+        }
+        if (!ok) {
+            std::remove(partial.c_str());
+            std::cerr << "Error: Unable to write report file!" << std::endl;
+            return false;
+        }
+        
+        out << "\nSales report exported to " << filename << std::endl;
+        return true;
+    }
+};
+
+// ReportManager class
+class ReportManager {
+public:
+    static void displayDailySales(std::ostream& out = std::cout) {
+        TRACE_SPAN("ReportManager::displayDailySales", "report");
+        
+        out << "\n\tDetails of Sales and Collection\n";
+        out << "\n------------------------------------------------------";
+        out << "\nItem                 Quantity Sold    Total Revenue";
+        out << "\n------------------------------------------------------";
+        
+        int totalRevenue = 0;
+        
+        Statement stmt = Database::getInstance().prepareRead(
+            "SELECT i.name, i.category, d.quantity, d.revenue "
+            "FROM daily_sales d "
+            "JOIN inventory i ON d.item_id = i.id "
+            "WHERE d.day = DATE('now') "
+            "ORDER BY i.category, i.name");
+        
+        for (auto [name, category, qtySold, revenue] : stmt.rows<std::string_view, std::string_view, int, int>()) {
+            out << "\n" << std::left << std::setw(20) << name 
+                     << std::right << std::setw(10) << qtySold
+                     << std::setw(15) << "$" << revenue;
+            
+            totalRevenue += revenue;
+        }
+        
+        out << "\n------------------------------------------------------";
+        out << "\nTotal Revenue:                          $" << totalRevenue;
+        out << "\n------------------------------------------------------\n";
+    }
+    
+    // Revenue per time bucket and item, category or user for the days fromDate..toDate (UTC)
+    static bool displayRevenueReport(TimeBucket size, SalesDimension dimension,
+                                     const std::string& fromDate, const std::string& toDate,
+                                     std::ostream& out = std::cout) {
+        TRACE_SPAN("ReportManager::displayRevenueReport", "report");
+        
+        long long from, to;
+        if (!parseDateRange(fromDate, toDate, from, to, out)) {
+            return false;
+        }
+        
+        std::vector<RevenueRow> rows = SalesAnalytics::revenue(size, dimension, from, to);
+        writeRevenueTable(size, fromDate, toDate, rows, out);
+        return true;
+    }
+        
+    // The revenue report for every property at once: each property's rows are
+    // computed in parallel, then rows with the same period and name are added up
+    static bool displayPropertyRevenue(TimeBucket size, SalesDimension dimension,
+                                       const std::string& fromDate, const std::string& toDate,
+                                       std::ostream& out = std::cout) {
+        TRACE_SPAN("ReportManager::displayPropertyRevenue", "report");
+        
+        long long from, to;
+        if (!parseDateRange(fromDate, toDate, from, to, out)) {
+            return false;
+        }
+        
+        std::vector<std::vector<RevenueRow>> perProperty = PropertyRouter::fanOut<std::vector<RevenueRow>>(
+            [=](const Property&) { return SalesAnalytics::revenue(size, dimension, from, to); });
+        
+        std::map<std::pair<long long, std::string>, RevenueRow> merged;
+        for (const std::vector<RevenueRow>& rows : perProperty) {
+            for (const RevenueRow& row : rows) {
+                auto inserted = merged.emplace(std::make_pair(row.bucketStart, row.key), row);
+                if (!inserted.second) {
+                    inserted.first->second.quantity += row.quantity;
+                    inserted.first->second.revenue += row.revenue;
+                }
+            }
+        }
+        
+        std::vector<RevenueRow> rows;
+        for (const auto& entry : merged) {
+            rows.push_back(entry.second);
+        }
+        out << "\n\tAll properties";
+        writeRevenueTable(size, fromDate, toDate, rows, out);
+        
+        out << "\nProperty                                              Revenue";
+        out << "\n------------------------------------------------------------------";
+        for (size_t p = 0; p < perProperty.size(); p++) {
+            long long revenue = 0;
+            for (const RevenueRow& row : perProperty[p]) {
+                revenue += row.revenue;
+            }
+            out << "\n" << std::left << std::setw(49) << PropertyRouter::find(static_cast<int>(p) + 1)->name
+                << std::right << std::setw(6) << "$" << revenue;
+        }
+        out << "\n------------------------------------------------------------------\n";
+        return true;
+    }
+    
+    static void displayInventoryStatus(std::ostream& out = std::cout) {
+        TRACE_SPAN("ReportManager::displayInventoryStatus", "report");
+        
+        out << "\n\tCurrent Inventory Status\n";
+        out << "\n------------------------------------------------------";
+        out << "\nItem                 Price    Available    Category";
+        out << "\n------------------------------------------------------";
+        
+        Statement stmt = Database::getInstance().prepareRead(
+            "SELECT name, price, quantity, category FROM inventory ORDER BY category, name");
+        
+        for (auto [name, price, quantity, category] : stmt.rows<std::string_view, int, int, std::string_view>()) {
+            out << "\n" << std::left << std::setw(20) << name 
+                     << std::right << std::setw(5) << "$" << price
+                     << std::setw(12) << quantity
+                     << std::setw(12) << category;
+        }
+        
+        out << "\n------------------------------------------------------\n";
+    }
+    
+    // Stock of every item at every property side by side, with the total across them
+    static void displayPropertyInventory(std::ostream& out = std::cout) {
+        TRACE_SPAN("ReportManager::displayPropertyInventory", "report");
+        
+        struct StockRow {
+            std::string category;
+            std::string name;
+            int quantity;
+        };
+        
+        std::vector<std::vector<StockRow>> perProperty = PropertyRouter::fanOut<std::vector<StockRow>>(
+            [](const Property&) {
+                std::vector<StockRow> rows;
+                Statement stmt = Database::getInstance().prepareRead("SELECT category, name, quantity FROM inventory");
+                for (StockRow row : stmt.rowsAs<StockRow, std::string, std::string, int>()) {
+                    rows.push_back(std::move(row));
+                }
+                return rows;
+            });
+        
+        // (category, name) -> quantity at each property
+        std::map<std::pair<std::string, std::string>, std::vector<int>> merged;
+        for (size_t p = 0; p < perProperty.size(); p++) {
+            for (const StockRow& row : perProperty[p]) {
+                std::vector<int>& quantities = merged[std::make_pair(row.category, row.name)];
+                quantities.resize(perProperty.size(), 0);
+                quantities[p] += row.quantity;
+            }
+        }
+        
+        std::string rule(34 + 12 * (perProperty.size() + 1), '-');
+        
+        out << "\n\tInventory Status, All Properties\n";
+        out << "\n" << rule;
+        out << "\n" << std::left << std::setw(20) << "Item" << std::setw(14) << "Category" << std::right;
+        for (size_t p = 0; p < perProperty.size(); p++) {
+            out << std::setw(12) << PropertyRouter::find(static_cast<int>(p) + 1)->name.substr(0, 11);
+        }
+        out << std::setw(12) << "Total";
+        out << "\n" << rule;
+        
+        for (const auto& entry : merged) {
+            out << "\n" << std::left << std::setw(20) << entry.first.second
+                << std::setw(14) << entry.first.first << std::right;
+            
+            long long total = 0;
+            for (int quantity : entry.second) {
+                out << std::setw(12) << quantity;
+                total += quantity;
+            }
+            out << std::setw(12) << total;
+        }
+        
+        out << "\n" << rule << "\n";
+    }
+    
+    static void resetDailySales() {
+        std::cout << "\nDo you want to archive today's sales data? (y/n): ";
+        char choice;
+        std::cin >> choice;
+        
+        if (choice == 'y' || choice == 'Y') {
+            // Export today's sales to CSV; they stay in the database until
+            // SalesArchive::Scheduler moves them out past the hot window
+            exportSalesReport();
+            std::cout << "\nSales data has been archived successfully!" << std::endl;
+        }
+    }
+    
+    static bool exportSalesReport(std::ostream& out = std::cout) {
+        int today = static_cast<int>(std::time(nullptr) / 86400);
+        return SalesExporter::exportRange(today, today, "sales_report_" + compactDate(today) + ".csv", out);
+    }
+    
+    // Sales from fromDate to toDate (YYYY-MM-DD, inclusive) to
+    // sales_report_<from>_<to>.csv, or .csv.gz when gzip is set
+    static bool exportSalesRange(const std::string& fromDate, const std::string& toDate, bool gzip,
+                                 std::ostream& out = std::cout) {
+        long long from, to;
+        if (!parseDateRange(fromDate, toDate, from, to, out)) {
+            return false;
+        }
+        
+        int fromDay = static_cast<int>(from / 86400);
+        int toDay = static_cast<int>(to / 86400) - 1;
+        std::string filename = "sales_report_" + compactDate(fromDay) + "_" + compactDate(toDay) + ".csv";
+        return SalesExporter::exportRange(fromDay, toDay, gzip ? filename + ".gz" : filename, out);
+    }
+
+private:
+    // YYYYMMDD, as used in report file names
+    static std::string compactDate(int day) {
+        std::string date = ReservationManager::formatDate(day);
+        date.erase(std::remove(date.begin(), date.end(), '-'), date.end());
+        return date;
+    }
+    
+private:
+    // fromDate..toDate (YYYY-MM-DD, inclusive) as [from, to) in seconds since 1970-01-01 UTC
+    static bool parseDateRange(const std::string& fromDate, const std::string& toDate,
+                               long long& from, long long& to, std::ostream& out) {
+        int fromDay, toDay;
+        if (!ReservationManager::parseDate(fromDate, fromDay) || !ReservationManager::parseDate(toDate, toDay) ||
+            toDay < fromDay) {
+            out << "\nInvalid date range! Use YYYY-MM-DD, oldest first.";
+            return false;
+        }
+        
+        from = fromDay * 86400LL;
+        to = (toDay + 1) * 86400LL;
+        return true;
+    }
+    
+    static void writeRevenueTable(TimeBucket size, const std::string& fromDate, const std::string& toDate,
+                                  const std::vector<RevenueRow>& rows, std::ostream& out) {
+        out << "\n\tRevenue from " << fromDate << " to " << toDate << "\n";
+        out << "\n------------------------------------------------------------------";
+        out << "\nPeriod              Name                 Quantity    Revenue";
+        out << "\n------------------------------------------------------------------";
+        
+        long long totalRevenue = 0;
+        for (const RevenueRow& row : rows) {
+            out << "\n" << std::left << std::setw(20) << SalesAnalytics::bucketLabel(size, row.bucketStart)
+                << std::setw(20) << row.key
+                << std::right << std::setw(9) << row.quantity
+                << std::setw(6) << "$" << row.revenue;
+            
+            totalRevenue += row.revenue;
+        }
+        
+        out << "\n------------------------------------------------------------------";
+        out << "\nTotal Revenue:                                        $" << totalRevenue;
+        out << "\n------------------------------------------------------------------\n";
+    }
+};
+
+// Application class (main controller)
+class HotelApp {
+private:
+    UserSession session;
+    
+public:
+    HotelApp() {}
+    
+    bool initialize(const DatabaseConfig& config = DatabaseConfig()) {
+        std::cout << "\n\t\t\t=================================================";
+        std::cout << "\n\t\t\t|        HOTEL MANAGEMENT SYSTEM                |";
+        std::cout << "\n\t\t\t=================================================";
+        
+        // Connect to database; main() has already opened any --property databases
+        if (PropertyRouter::count() == 0 && !PropertyRouter::addProperty("Main", "hotel.db", config)) {
+            std::cerr << "Failed to initialize database!" << std::endl;
+            return false;
+        }
+        
+        // Login
+        return login();
+    }
+    
+    bool login() {
+        std::string username, password;
+        int attempts = 0;
+        
+        // Everything this session does goes to the chosen property's database
+        int propertyId = chooseProperty();
+        Database::route(PropertyRouter::database(propertyId));
+        
+        while (attempts < 3) {
+            std::cout << "\n\n=== LOGIN ===";
+            std::cout << "\nUsername: ";
+            std::cin >> username;
+            std::cout << "Password: ";
+            std::cin >> password;
+            
+            session = UserManager::login(username, password);
+            session.propertyId = propertyId;
+            
+            if (session.isLoggedIn()) {
+                std::cout << "\nLogin successful! Welcome, " << username << "!";
+                return true;
+            } else {
+                attempts++;
+                std::cout << "\nInvalid username or password. Attempts remaining: " << (3 - attempts);
+            }
+        }
+        
+        std::cout << "\nToo many failed attempts. Exiting program...";
+        return false;
+    }
+    
+    void run() {
+        int choice;
+        SalesArchive::Scheduler archiver(Database::getInstance().getConfig().archiveInterval);
+        
+        while (true) {
+            displayMenu();
+            
+            // Get user choice with error handling
+            if (!(std::cin >> choice)) {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                choice = -1;  // Invalid input
+            }
+            
+            // Process menu choice
+            if (processMenuChoice(choice)) {
+                break;  // Exit program
+            }
+            
+            std::cout << "\n\nPress Enter to continue...";
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cin.get();
+        }
+    }
+    
+private:
+    int chooseProperty() {
+        if (PropertyRouter::count() < 2) {
+            return 1;
+        }
+        
+        while (true) {
+            std::cout << "\n\n=== PROPERTY ===";
+            for (const Property* property : PropertyRouter::all()) {
+                std::cout << "\n" << property->id << ") " << property->name;
+            }
+            std::cout << "\nProperty: ";
+            
+            int id;
+            if (std::cin >> id && PropertyRouter::find(id)) {
+                return id;
+            }
+            if (std::cin.eof()) {
+                return 1;
+            }
+            
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << "Invalid property!";
+        }
+    }
+    
+    // Admins running several properties may report on all of them at once
+    bool askAllProperties() {
+        if (!session.isAdmin() || PropertyRouter::count() < 2) {
+            return false;
+        }
+        
+        char answer;
+        std::cout << "\nAll properties? (y/n): ";
+        std::cin >> answer;
+        return answer == 'y' || answer == 'Y';
+    }
+    
+    void displayMenu() {
+        TRACE_SPAN("HotelApp::displayMenu", "ui");
+        
+        std::shared_ptr<const InventoryManager::Catalog> catalog = InventoryManager::getCatalog();
+        const std::vector<Item>& items = catalog->items;
+        
+        std::cout << "\n\n\t\t\t Please select from the menu options ";
+        
+        int menuIndex = 1;
+        
+        // Display inventory items
+        for (const auto& item : items) {
+            std::cout << "\n" << menuIndex++ << ") " << item.getName() 
+                     << " - $" << item.getPrice();
+        }
+        
+        // Display admin options
+        std::cout << "\n" << menuIndex++ << ") Order multiple items";
+        std::cout << "\n" << menuIndex++ << ") Book a room";
+        std::cout << "\n" << menuIndex++ << ") View sales report";
+        std::cout << "\n" << menuIndex++ << ") View inventory status";
+        
+        if (session.isAdmin()) {
+            std::cout << "\n" << menuIndex++ << ") Reset daily sales";
+            std::cout << "\n" << menuIndex++ << ") Add new user";
+            std::cout << "\n" << menuIndex++ << ") Revenue report";
+            std::cout << "\n" << menuIndex++ << ") Query statistics";
+        }
+        
+        std::cout << "\n" << menuIndex << ") Exit";
+        std::cout << "\n\nPlease Enter your choice: ";
+    }
+    
+    bool processMenuChoice(int choice) {
+        TRACE_SPAN("HotelApp::processMenuChoice", "ui");
+        
+        std::shared_ptr<const InventoryManager::Catalog> catalog = InventoryManager::getCatalog();
+        const std::vector<Item>& items = catalog->items;
+        
+        // Handle item purchases (1 to items.size())
+        if (choice >= 1 && choice <= static_cast<int>(items.size())) {
+            int index = choice - 1;
+            int quantity;
+            
+            std::cout << "\n\nEnter " << items[index].getName() << " quantity: ";
+            std::cin >> quantity;
+            
+            if (quantity > 0) {
+                OrderManager::processOrder(items[index].getId(), quantity, session.userId);
+            } else {
+                std::cout << "\nInvalid quantity!";
+            }
+            
+            return false;  // Don't exit
+        }
+        
+        // Handle special options
+        int specialOptionStart = items.size() + 1;
+        
+        if (choice == specialOptionStart) {
+            // Multi-item order
+            takeCartOrder(items);
+        }
+        else if (choice == specialOptionStart + 1) {
+            // Room reservation by date
+            takeReservation(items);
+        }
+        else if (choice == specialOptionStart + 2) {
+            // View sales report
+            ReportManager::displayDailySales();
+        } 
+        else if (choice == specialOptionStart + 3) {
+            // View inventory status
+            if (askAllProperties()) {
+                ReportManager::displayPropertyInventory();
+            } else {
+                ReportManager::displayInventoryStatus();
+            }
+        }
+        else if (session.isAdmin() && choice == specialOptionStart + 4) {
+            // Reset daily sales (admin only)
+            ReportManager::resetDailySales();
+        }
+        else if (session.isAdmin() && choice == specialOptionStart + 5) {
+            // Add new user (admin only)
+            addNewUser();
+        }
+        else if (session.isAdmin() && choice == specialOptionStart + 6) {
+            // Revenue by period (admin only)
+            takeRevenueReport();
+        }
+        else if (session.isAdmin() && choice == specialOptionStart + 7) {
+            // Per-query latency statistics (admin only)
+            showQueryStats();
+        }
+        else if ((session.isAdmin() && choice == specialOptionStart + 8) ||
+                 (!session.isAdmin() && choice == specialOptionStart + 4)) {
+            // Exit
+            std::cout << "\nExiting program...";
+            return true;
+        }
+        else {
+            std::cout << "\nPlease select a valid option!";
+        }
+        
+        return false;
+    }
+    
+    void takeCartOrder(const std::vector<Item>& items) {
+        std::vector<OrderLine> cart;
+        
+        std::cout << "\n=== Order Multiple Items ===";
+        std::cout << "\nEnter item number and quantity for each line (0 to finish)";
+        
+        while (true) {
+            int number;
+            std::cout << "\nItem number: ";
+            
+            if (!(std::cin >> number) || number == 0) {
+                break;
+            }
+            
+            if (number < 1 || number > static_cast<int>(items.size())) {
+                std::cout << "Invalid item!";
+                continue;
+            }
+            
+            int quantity;
+            std::cout << items[number - 1].getName() << " quantity: ";
+            std::cin >> quantity;
+            
+            if (quantity > 0) {
+                cart.push_back({items[number - 1].getId(), quantity});
+            } else {
+                std::cout << "Invalid quantity!";
+            }
+        }
+        
+        if (!std::cin) {
+            std::cin.clear();
+        }
+        
+        OrderManager::processCart(cart, session.userId);
+    }
+    
+    void takeReservation(const std::vector<Item>& items) {
+        int number, nights;
+        std::string checkIn;
+        
+        std::cout << "\n=== Book a Room ===";
+        std::cout << "\nRoom type (menu number): ";
+        std::cin >> number;
+        
+        if (!std::cin || number < 1 || number > static_cast<int>(items.size()) ||
+            items[number - 1].getCategory() != "accommodation") {
+            std::cin.clear();
+            std::cout << "Invalid room type!";
+            return;
+        }
+        
+        std::cout << "Check-in date (YYYY-MM-DD, today is " << ReservationManager::todayDate() << "): ";
+        std::cin >> checkIn;
+        std::cout << "Nights: ";
+        std::cin >> nights;
+        
+        int itemId = items[number - 1].getId();
+        RoomBooking booking;
+        if (ReservationManager::bookRoom(itemId, checkIn, nights, session.userId, booking)) {
+            return;
+        }
+        
+        // Offer the earliest opening in the following weeks instead
+        RoomBooking next;
+        if (!ReservationManager::findAvailable(itemId, nights, checkIn, 60, next)) {
+            return;
+        }
+        
+        char answer;
+        std::cout << "\nNext opening: room " << next.roomNumber << " from " << next.checkIn
+                  << " to " << next.checkOut << ". Book it? (y/n): ";
+        std::cin >> answer;
+        
+        if (answer == 'y' || answer == 'Y') {
+            ReservationManager::bookRoom(itemId, next.checkIn, nights, session.userId, booking);
+        }
+    }
+    
+    void takeRevenueReport() {
+        std::string period, grouping, fromDate, toDate;
+        
+        std::cout << "\n=== Revenue Report ===";
+        std::cout << "\nPeriod (hour/day/week/month): ";
+        std::cin >> period;
+        std::cout << "Group by (item/category/user): ";
+        std::cin >> grouping;
+        std::cout << "From date (YYYY-MM-DD): ";
+        std::cin >> fromDate;
+        std::cout << "To date (YYYY-MM-DD): ";
+        std::cin >> toDate;
+        
+        TimeBucket size;
+        SalesDimension dimension;
+        if (!SalesAnalytics::parseTimeBucket(period, size) || !SalesAnalytics::parseDimension(grouping, dimension)) {
+            std::cout << "\nInvalid period or grouping!";
+            return;
+        }
+        
+        if (askAllProperties()) {
+            ReportManager::displayPropertyRevenue(size, dimension, fromDate, toDate);
+        } else {
+            ReportManager::displayRevenueReport(size, dimension, fromDate, toDate);
+        }
+    }
+    
+    void showQueryStats() {
+        QueryStats::display();
+        
+        std::cout << "\n1) " << (QueryStats::isEnabled() ? "Stop" : "Start") << " collecting"
+                  << "  2) Reset  3) Save to query_stats.json  0) Back";
+        std::cout << "\nChoice: ";
+        
+        int choice = 0;
+        std::cin >> choice;
+        
+        if (choice == 1) {
+            QueryStats::setEnabled(!QueryStats::isEnabled());
+        } else if (choice == 2) {
+            QueryStats::reset();
+        } else if (choice == 3 && QueryStats::writeJson("query_stats.json")) {
+            std::cout << "\nStatistics saved to query_stats.json";
+        }
+    }
+    
+    void addNewUser() {
+        std::string username, password, role;
+        
+        std::cout << "\n=== Add New User ===";
+        std::cout << "\nUsername: ";
+        std::cin >> username;
+        std::cout << "Password: ";
+        std::cin >> password;
+        std::cout << "Role (admin/staff): ";
+        std::cin >> role;
+        
+        if (!UserManager::isValidRole(role)) {
+            std::cout << "\nInvalid role! Using 'staff' as default.";
+            role = "staff";
+        }
+        
+        if (UserManager::addUser(username, password, role)) {
+            std::cout << "\nUser added successfully!";
+        } else {
+            std::cout << "\nFailed to add user. Username may already exist.";
+        }
+    }
+};
+
+// CommandProcessor class
+// The request language spoken by the order server and by batch scripts.
+// One request per line:
+//   PROPERTIES                       LOGIN <username> <password> [property id]
+//   MENU                             ORDER <item id> <quantity>
+//   CART <item id>:<quantity> ...    BOOK <item id> <check-in> <nights>
+//   FINDROOM <item id> <nights> <earliest check-in> <window days>
+//   SALES    INVENTORY [ALL]    EXPORT [<from date> <to date> [GZIP]]
+//   ADDUSER <username> <password> <role>    IMPORT <catalog file>
+//   REVENUE <hour|day|week|month> <item|category|user> <from date> <to date> [ALL]
+//   STATS
+// PROPERTIES lists "<id>\t<name>" and works before LOGIN. A session stays on
+// the property it logged in to (1 by default); ALL reports on every property.
+// EXPORT writes today's sales CSV, then moves old sales to the monthly archives;
+// with dates it writes that range of sales instead, gzip-compressed with GZIP.
+// IMPORT upserts inventory from a CSV or JSON file on the server's side.
+class CommandProcessor {
+public:
+    // Requests that only write, which a batch can group into one transaction
+    static bool isWrite(const std::string& command) {
+        return command == "ORDER" || command == "CART" || command == "BOOK" || command == "ADDUSER";
+    }
+    
+    // Run one request line for the session; returns "OK" or "ERR <reason>" and writes the body to out
+    static std::string execute(UserSession& session, const std::string& line, std::ostream& out) {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+        
+        // Only the command word: LOGIN lines carry a password
+        TRACE_SPAN("CommandProcessor::execute", "server", command);
+        
+        if (command == "PROPERTIES") {
+            for (const Property* property : PropertyRouter::all()) {
+                out << property->id << '\t' << property->name << '\n';
+            }
+            return "OK";
+        }
+        
+        if (command == "LOGIN") {
+            std::string username, password, property;
+            args >> username >> password >> property;
+            
+            int propertyId = property.empty() ? 1 : std::atoi(property.c_str());
+            Database* database = PropertyRouter::database(propertyId);
+            if (!database) {
+                return "ERR unknown property";
+            }
+            
+            PropertyScope scope(database);
+            UserSession login = UserManager::login(username, password);
+            if (!login.isLoggedIn()) {
+                return "ERR invalid username or password";
+            }
+            
+            session = login;
+            session.propertyId = propertyId;
+            out << session.userId << " " << session.role;
+            return "OK";
+        }
+        
+        if (!session.isLoggedIn()) {
+            return "ERR login required";
+        }
+        
+        PropertyScope scope(PropertyRouter::database(session.propertyId));
+        
+        if (command == "MENU") {
+            std::shared_ptr<const InventoryManager::Catalog> catalog = InventoryManager::getCatalog();
+            for (const Item& item : catalog->items) {
+                out << item.getId() << '\t' << item.getName() << '\t'
+                    << item.getPrice() << '\t' << item.getCategory() << '\n';
+            }
+            return "OK";
+        }
+        
+        if (command == "ORDER") {
+            int itemId = 0, quantity = 0;
+            if (!(args >> itemId >> quantity) || quantity <= 0) {
+                return "ERR usage: ORDER <item id> <quantity>";
+            }
+            return OrderManager::processOrder(itemId, quantity, session.userId, out) ? "OK" : "ERR order rejected";
+        }
+        
+        if (command == "CART") {
+            std::vector<OrderLine> cart;
+            std::string entry;
+            
+            while (args >> entry) {
+                size_t colon = entry.find(':');
+                if (colon == std::string::npos) {
+                    return "ERR usage: CART <item id>:<quantity> ...";
+                }
+                try {
+                    cart.push_back({std::stoi(entry.substr(0, colon)), std::stoi(entry.substr(colon + 1))});
+                } catch (const std::exception&) {
+                    return "ERR usage: CART <item id>:<quantity> ...";
+                }
+            }
+            return OrderManager::processCart(cart, session.userId, out) ? "OK" : "ERR order rejected";
+        }
+        
+        if (command == "BOOK") {
+            int itemId = 0, nights = 0;
+            std::string checkIn;
+            if (!(args >> itemId >> checkIn >> nights)) {
+                return "ERR usage: BOOK <item id> <check-in> <nights>";
+            }
+            
+            RoomBooking booking;
+            return ReservationManager::bookRoom(itemId, checkIn, nights, session.userId, booking, out)
+                ? "OK" : "ERR booking rejected";
+        }
+        
+        if (command == "FINDROOM") {
+            int itemId = 0, nights = 0, windowDays = 0;
+            std::string earliest;
+            if (!(args >> itemId >> nights >> earliest >> windowDays)) {
+                return "ERR usage: FINDROOM <item id> <nights> <earliest check-in> <window days>";
+            }
+            
+            RoomBooking found;
+            if (!ReservationManager::findAvailable(itemId, nights, earliest, windowDays, found)) {
+                return "ERR no room available";
+            }
+            out << found.roomNumber << " " << found.checkIn << " " << found.checkOut;
+            return "OK";
+        }
+        
+        if (command == "SALES") {
+            ReportManager::displayDailySales(out);
+            return "OK";
+        }
+        
+        if (command == "INVENTORY") {
+            std::string scope;
+            if (args >> scope) {
+                if (scope != "ALL") {
+                    return "ERR usage: INVENTORY [ALL]";
+                }
+                if (!session.isAdmin()) {
+                    return "ERR admin only";
+                }
+                ReportManager::displayPropertyInventory(out);
+                return "OK";
+            }
+            
+            ReportManager::displayInventoryStatus(out);
+            return "OK";
+        }
+        
+        if (command == "EXPORT" || command == "ADDUSER" || command == "REVENUE" || command == "STATS" ||
+            command == "IMPORT") {
+            if (!session.isAdmin()) {
+                return "ERR admin only";
+            }
+            
+            if (command == "IMPORT") {
+                std::string path;
+                if (!std::getline(args >> std::ws, path) || path.empty()) {
+                    return "ERR usage: IMPORT <catalog file>";
+                }
+                return InventoryImporter::importFile(path, out) ? "OK" : "ERR import failed";
+            }
+            
+            if (command == "EXPORT") {
+                std::string fromDate, toDate, format;
+                if (args >> fromDate) {
+                    if (!(args >> toDate) || (args >> format && format != "GZIP")) {
+                        return "ERR usage: EXPORT [<from date> <to date> [GZIP]]";
+                    }
+                    return ReportManager::exportSalesRange(fromDate, toDate, format == "GZIP", out) ? "OK"
+                                                                                                    : "ERR export failed";
+                }
+                
+                return ReportManager::exportSalesReport(out) ? "OK" : "ERR export failed";
+            }
+            
+            if (command == "STATS") {
+                QueryStats::display(out);
+                return "OK";
+            }
+            
+            if (command == "REVENUE") {
+                std::string period, grouping, fromDate, toDate, scope;
+                TimeBucket size;
+                SalesDimension dimension;
+                if (!(args >> period >> grouping >> fromDate >> toDate) || (args >> scope && scope != "ALL") ||
+                    !SalesAnalytics::parseTimeBucket(period, size) || !SalesAnalytics::parseDimension(grouping, dimension)) {
+                    return "ERR usage: REVENUE <hour|day|week|month> <item|category|user> <from date> <to date> [ALL]";
+                }
+                
+                bool ok = scope == "ALL" ? ReportManager::displayPropertyRevenue(size, dimension, fromDate, toDate, out)
+                                         : ReportManager::displayRevenueReport(size, dimension, fromDate, toDate, out);
+                return ok ? "OK" : "ERR invalid date range";
+            }
+            
+            std::string username, password, role;
+            if (!(args >> username >> password >> role)) {
+                return "ERR usage: ADDUSER <username> <password> <role>";
+            }
+            if (!UserManager::isValidRole(role)) {
+                return "ERR role must be admin or staff";
+            }
+            return UserManager::addUser(username, password, role) ? "OK" : "ERR username may already exist";
+        }
+        
+        return "ERR unknown command";
+    }
+};
+
+// BatchRunner class
+// Runs a script of CommandProcessor requests without prompts, one per line;
+// blank lines and lines starting with '#' are skipped and QUIT ends it.
+// Consecutive writes share one transaction, committed every groupSize
+// commands, and each runs in a savepoint of its own so a rejected one is
+// undone alone. Any other request commits the open group first, so reports
+// see every write above them. Each request gets a result line,
+// "<line number>\t<OK or ERR reason>\t<request>", printed once it is
+// committed, and reports print their body after it. A group that fails to
+// commit has its requests marked "ERR not committed" and stops the script.
+class BatchRunner {
+private:
+    struct Result {
+        int lineNumber;
+        std::string status;
+        std::string request;
+    };
+    
+    int groupSize;
+    std::ostream& log;
+    UserSession session;
+    std::unique_ptr<Transaction> group;
+    Database* groupDatabase = nullptr;  // the property the open group writes to
+    std::vector<Result> pending;  // results waiting for the group to commit
+    long commands = 0;
+    long failures = 0;
+    long commits = 0;
+    
+    void report(const Result& result) {
+        if (result.status != "OK") {
+            failures++;
+        }
+        log << result.lineNumber << '\t' << result.status << '\t' << result.request << '\n';
+    }
+    
+    // Commit the open group and print its results; false if the commit failed
+    bool commitGroup() {
+        if (!group) {
+            return true;
+        }
+        
+        bool ok = group->commit();
+        group.reset();
+        commits += ok ? 1 : 0;
+        
+        // Rooms booked in the group are still marked in the cached calendar
+        if (!ok) {
+            PropertyScope scope(groupDatabase);
+            ReservationManager::invalidateCalendar();
+        }
+        
+        for (Result& result : pending) {
+            if (!ok && result.status == "OK") {
+                result.status = "ERR not committed";
+            }
+            report(result);
+        }
+        pending.clear();
+        return ok;
+    }
+    
+    // First non-blank line of a response body
+    static std::string firstLine(const std::string& body) {
+        std::istringstream lines(body);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos) {
+                return line.substr(start);
+            }
+        }
+        return "";
+    }
+    
+public:
+    explicit BatchRunner(int groupSize, std::ostream& log = std::cout)
+        : groupSize(std::max(1, groupSize)), log(log) {}
+    
+    // Returns false if any request failed or a group could not be committed
+    bool run(std::istream& script) {
+        TRACE_SPAN("BatchRunner::run", "batch");
+        
+        auto started = std::chrono::steady_clock::now();
+        std::string line;
+        int lineNumber = 0;
+        bool committed = true;
+        
+        while (committed && std::getline(script, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            
+            std::istringstream words(line);
+            std::string command;
+            if (!(words >> command) || command[0] == '#') {
+                continue;
+            }
+            if (command == "QUIT") {
+                break;
+            }
+            
+            // Passwords stay out of the log
+            Result result{lineNumber, "", line};
+            if (command == "LOGIN" || command == "ADDUSER") {
+                std::string username, password, rest;
+                words >> username >> password;
+                std::getline(words, rest);
+                result.request = command + " " + username + rest;
+            }
+            std::ostringstream body;
+            commands++;
+            
+            if (!CommandProcessor::isWrite(command) || !session.isLoggedIn()) {
+                committed = commitGroup();
+                if (!committed) {
+                    break;
+                }
+                
+                result.status = CommandProcessor::execute(session, line, body);
+                report(result);
+                log << body.str();
+                if (!body.str().empty() && body.str().back() != '\n') {
+                    log << '\n';
+                }
+                continue;
+            }
+            
+            PropertyScope scope(PropertyRouter::database(session.propertyId));
+            if (!group) {
+                // If the database is busy, the request makes its own attempt alone
+                group = std::make_unique<Transaction>();
+                groupDatabase = &Database::getInstance();
+                if (!group->isActive()) {
+                    group.reset();
+                }
+            }
+            
+            result.status = CommandProcessor::execute(session, line, body);
+            std::string reason = result.status == "OK" ? "" : firstLine(body.str());
+            if (!reason.empty()) {
+                result.status += ": " + reason;
+            }
+            
+            if (!group) {
+                report(result);
+                continue;
+            }
+            pending.push_back(result);
+            if (static_cast<int>(pending.size()) >= groupSize) {
+                committed = commitGroup();
+            }
+        }
+        
+        committed = commitGroup() && committed;
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        log << "# " << commands << " requests, " << failures << " failed, " << commits << " commits in "
+            << std::fixed << std::setprecision(2) << seconds << " s" << std::endl;
+        return committed && failures == 0;
+    }
+};
+
+#ifndef _WIN32
+// Multi-session order server over a Unix domain socket. Sessions send
+// CommandProcessor requests, and QUIT to hang up.
+// Each response is an "OK" or "ERR <reason>" line, then the body lines, then
+// a line holding a single ".". Body lines starting with "." get an extra ".".
+
+// Line-oriented reads and writes on a connected socket
+class SocketChannel {
+private:
+    int fd;
+    std::string buffer;
+    
+public:
+    explicit SocketChannel(int fd = -1) : fd(fd) {}
+    
+    int getFd() const { return fd; }
+    
+    bool readLine(std::string& line) {
+        while (true) {
+            size_t pos = buffer.find('\n');
+            if (pos != std::string::npos) {
+                line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                return true;
+            }
+            
+            char chunk[4096];
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(chunk, n);
+        }
+    }
+    
+    bool writeAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+    
+    static std::string formatResponse(const std::string& status, const std::string& body) {
+        std::string response = status + "\n";
+        std::istringstream lines(body);
+        std::string line;
+        
+        while (std::getline(lines, line)) {
+            if (!line.empty() && line[0] == '.') {
+                response += ".";
+            }
+            response += line + "\n";
+        }
+        
+        return response + ".\n";
+    }
+    
+    bool readResponse(std::string& status, std::string& body) {
+        if (!readLine(status)) {
+            return false;
+        }
+        
+        body.clear();
+        std::string line;
+        
+        while (readLine(line)) {
+            if (line == ".") {
+                return true;
+            }
+            if (!line.empty() && line[0] == '.') {
+                line.erase(0, 1);
+            }
+            body += line + "\n";
+        }
+        
+        return false;
+    }
+};
+
+// Server settings taken from the command line
+struct ServerConfig {
+    std::string socketPath = "hotel.sock";
+    int workers = 4;
+    int queueCapacity = 64;
 };
 
-// OrderManager class
-class OrderManager {
+// Accepts terminal sessions and runs their requests on a fixed worker pool.
+// Each session has one reader thread that queues a request and waits for
+// its response, so requests from one terminal are handled in order.
+class OrderServer {
+private:
+    struct Request {
+        UserSession* session;
+        std::string line;
+        std::promise<std::string> response;
+    };
+    
+    ServerConfig config;
+    BoundedQueue<std::unique_ptr<Request>> queue;
+    std::vector<std::thread> workers;
+    
+    std::mutex sessionsMutex;
+    std::condition_variable sessionsDone;
+    std::vector<int> sessionFds;
+    
+    static volatile std::sig_atomic_t stopRequested;
+    
+    static void onStopSignal(int) {
+        stopRequested = 1;
+    }
+    
 public:
-    static bool processOrder(int itemId, int quantity, int userId) {
-        Item item = InventoryManager::getItemById(itemId);
-        int currentQty = InventoryManager::getQuantity(itemId);
+    explicit OrderServer(const ServerConfig& config)
+        : config(config), queue(config.queueCapacity) {}
+    
+    bool run() {
+        int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            std::cerr << "Error: Unable to create socket!" << std::endl;
+            return false;
+        }
         
-        if (currentQty < quantity) {
-            std::cout << "\nNot enough inventory. Only " << currentQty << " available." << std::endl;
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (config.socketPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: Socket path is too long!" << std::endl;
+            ::close(listenFd);
             return false;
         }
+        std::strncpy(address.sun_path, config.socketPath.c_str(), sizeof(address.sun_path) - 1);
         
-        int totalPrice = item.getPrice() * quantity;
+        // Remove a socket left behind by a previous run
+        ::unlink(config.socketPath.c_str());
         
-        // Begin transaction
-        Database::getInstance().executeQuery("BEGIN TRANSACTION");
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            ::listen(listenFd, 64) < 0) {
+            std::cerr << "Error: Unable to listen on " << config.socketPath << std::endl;
+            ::close(listenFd);
+            return false;
+        }
         
-        bool success = true;
+        std::signal(SIGINT, &OrderServer::onStopSignal);
+        std::signal(SIGTERM, &OrderServer::onStopSignal);
         
-        // Update inventory
-        if (!InventoryManager::decreaseQuantity(itemId, quantity)) {
-            success = false;
+        for (int i = 0; i < config.workers; i++) {
+            workers.emplace_back([this] { workerLoop(); });
         }
         
-        // Record sale
-        std::string saleQuery = "INSERT INTO sales (item_id, quantity, total_price, user_id) VALUES (" +
-                              std::to_string(itemId) + ", " +
-                              std::to_string(quantity) + ", " +
-                              std::to_string(totalPrice) + ", " +
-                              std::to_string(userId) + ")";
+        // Old sales move to the monthly archives in the background while the server runs
+        SalesArchive::Scheduler archiver(Database::getInstance().getConfig().archiveInterval, &std::cout);
         
-        if (!Database::getInstance().executeQuery(saleQuery)) {
-            success = false;
-        }
+        std::cout << "\nServer listening on " << config.socketPath
+                  << " with " << config.workers << " workers" << std::endl;
         
-        // Commit or rollback
-        if (success) {
-            Database::getInstance().executeQuery("COMMIT");
-            
-            // Display order confirmation
-            std::cout << "\n\n\t\t" << quantity << " " << item.getName();
-            
-            if (item.getCategory() == "accommodation") {
-                std::cout << "(s) have been allotted to you";
-            } else {
-                std::cout << " is the order!";
+        while (!stopRequested) {
+            pollfd pending{listenFd, POLLIN, 0};
+            if (::poll(&pending, 1, 500) <= 0) {
+                continue;
             }
             
-            // Show bill
-            std::cout << "\n\n Bill details:";
-            std::cout << "\n Item: " << item.getName();
-            std::cout << "\n Quantity: " << quantity; 
-            std::cout << "\n Price per item: $" << item.getPrice();
-            std::cout << "\n Total: $" << totalPrice << std::endl;
+            int clientFd = ::accept(listenFd, nullptr, nullptr);
+            if (clientFd < 0) {
+                continue;
+            }
             
-            return true;
-        } else {
-            Database::getInstance().executeQuery("ROLLBACK");
-            return false;
+            {
+                std::lock_guard<std::mutex> lock(sessionsMutex);
+                sessionFds.push_back(clientFd);
+            }
+            std::thread([this, clientFd] { serveSession(clientFd); }).detach();
         }
-    }
-};
-
-// ReportManager class
-class ReportManager {
-public:
-    static void displayDailySales() {
-        std::cout << "\n\tDetails of Sales and Collection\n";
-        std::cout << "\n------------------------------------------------------";
-        std::cout << "\nItem                 Quantity Sold    Total Revenue";
-        std::cout << "\n------------------------------------------------------";
         
-        int totalRevenue = 0;
+        std::cout << "\nShutting down server..." << std::endl;
+        ::close(listenFd);
+        ::unlink(config.socketPath.c_str());
         
-        Database::getInstance().executeSelect(
-            "SELECT i.name, i.category, SUM(s.quantity) as qty_sold, SUM(s.total_price) as revenue "
-            "FROM sales s "
-            "JOIN inventory i ON s.item_id = i.id "
-            "WHERE DATE(s.timestamp) = DATE('now') "
-            "GROUP BY s.item_id "
-            "ORDER BY i.category, i.name",
-            [&totalRevenue](int argc, char** argv, char** azColName) {
-                if (argc >= 4) {
-                    std::string name = argv[0];
-                    int qtySold = std::stoi(argv[2]);
-                    int revenue = std::stoi(argv[3]);
-                    
-                    std::cout << "\n" << std::left << std::setw(20) << name 
-                             << std::right << std::setw(10) << qtySold
-                             << std::setw(15) << "$" << revenue;
-                    
-                    totalRevenue += revenue;
-                }
+        // Wake the session threads and let their in-flight requests finish
+        {
+            std::unique_lock<std::mutex> lock(sessionsMutex);
+            for (int fd : sessionFds) {
+                ::shutdown(fd, SHUT_RDWR);
             }
-        );
-        
-        std::cout << "\n------------------------------------------------------";
-        std::cout << "\nTotal Revenue:                          $" << totalRevenue;
-        std::cout << "\n------------------------------------------------------\n";
-    }
-    
-    static void displayInventoryStatus() {
-        std::cout << "\n\tCurrent Inventory Status\n";
-        std::cout << "\n------------------------------------------------------";
-        std::cout << "\nItem                 Price    Available    Category";
-        std::cout << "\n------------------------------------------------------";
+            sessionsDone.wait(lock, [this] { return sessionFds.empty(); });
+        }
         
-        Database::getInstance().executeSelect(
-            "SELECT name, price, quantity, category FROM inventory ORDER BY category, name",
-            [](int argc, char** argv, char** azColName) {
-                if (argc >= 4) {
-                    std::string name = argv[0];
-                    int price = std::stoi(argv[1]);
-                    int quantity = std::stoi(argv[2]);
-                    std::string category = argv[3];
-                    
-                    std::cout << "\n" << std::left << std::setw(20) << name 
-                             << std::right << std::setw(5) << "$" << price
-                             << std::setw(12) << quantity
-                             << std::setw(12) << category;
-                }
-            }
-        );
+        queue.close();
+        for (auto& worker : workers) {
+            worker.join();
+        }
         
-        std::cout << "\n------------------------------------------------------\n";
+        return true;
     }
     
-    static void resetDailySales() {
-        std::cout << "\nDo you want to archive today's sales data? (y/n): ";
-        char choice;
-        std::cin >> choice;
+private:
+    void serveSession(int fd) {
+        SocketChannel channel(fd);
+        UserSession session;
+        std::string line;
         
-        if (choice == 'y' || choice == 'Y') {
-            // Export today's sales to CSV
-            exportSalesReport();
+        while (channel.readLine(line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
             
-            // Don't actually delete the sales data from database
-            // This just archives it to CSV for reporting purposes
-            std::cout << "\nSales data has been archived successfully!" << std::endl;
+            if (line == "QUIT") {
+                channel.writeAll(SocketChannel::formatResponse("OK", "Goodbye"));
+                break;
+            }
+            
+            auto request = std::make_unique<Request>();
+            request->session = &session;
+            request->line = line;
+            std::future<std::string> response = request->response.get_future();
+            
+            if (!queue.push(std::move(request))) {
+                channel.writeAll(SocketChannel::formatResponse("ERR server shutting down", ""));
+                break;
+            }
+            
+            if (!channel.writeAll(response.get())) {
+                break;
+            }
         }
-    }
-    
-private:
-    static void exportSalesReport() {
-        // Get current date for filename
-        std::time_t now = std::time(nullptr);
-        std::tm* localTime = std::localtime(&now);
         
-        char dateStr[20];
-        std::strftime(dateStr, sizeof(dateStr), "%Y%m%d", localTime);
+        ::close(fd);
         
-        std::string filename = "sales_report_" + std::string(dateStr) + ".csv";
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        sessionFds.erase(std::find(sessionFds.begin(), sessionFds.end(), fd));
+        sessionsDone.notify_all();
+    }
+    
+    void workerLoop() {
+        std::unique_ptr<Request> request;
         
-        std::ofstream report(filename);
-        if (!report) {
-            std::cerr << "Error: Unable to create report file!" << std::endl;
-            return;
+        while (queue.pop(request)) {
+            std::ostringstream body;
+            std::string status = CommandProcessor::execute(*request->session, request->line, body);
+            request->response.set_value(SocketChannel::formatResponse(status, body.str()));
         }
-        
-        // Write CSV header
-        report << "Date,Item,Category,Quantity,Unit Price,Total Price,User\n";
-        
-        // Query and write sales data
-        Database::getInstance().executeSelect(
-            "SELECT s.timestamp, i.name, i.category, s.quantity, i.price, s.total_price, u.username "
-            "FROM sales s "
-            "JOIN inventory i ON s.item_id = i.id "
-            "JOIN users u ON s.user_id = u.id "
-            "WHERE DATE(s.timestamp) = DATE('now') "
-            "ORDER BY s.timestamp",
-            [&report](int argc, char** argv, char** azColName) {
-                if (argc >= 7) {
-                    report << argv[0] << "," // timestamp
-                          << argv[1] << "," // item name
-                          << argv[2] << "," // category
-                          << argv[3] << "," // quantity
-                          << argv[4] << "," // unit price
-                          << argv[5] << "," // total price
-                          << argv[6] << "\n"; // username
-                }
-            }
-        );
-        
-        report.close();
-        std::cout << "\nSales report exported to " << filename << std::endl;
     }
 };
 
-// UserManager class
-class UserManager {
-public:
-    static int authenticateUser(const std::string& username, const std::string& password) {
-        int userId = -1;
-        
-        // Escape input strings to prevent SQL injection
-        std::string safeUsername = sqlEscape(username);
-        std::string safePassword = sqlEscape(password);
+volatile std::sig_atomic_t OrderServer::stopRequested = 0;
+
+// Terminal front end that talks to an OrderServer instead of opening hotel.db
+class RemoteClient {
+private:
+    SocketChannel channel;
+    std::string currentUserRole;
+    int propertyCount = 1;
+    
+    // Send one request; prints the reason when the server refuses it
+    bool request(const std::string& line, std::string& body) {
+        std::string status;
         
-        Database::getInstance().executeSelect(
-            "SELECT id FROM users WHERE username = '" + safeUsername + "' AND password = '" + safePassword + "'",
-            [&userId](int argc, char** argv, char** azColName) {
-                if (argc >= 1) {
-                    userId = std::stoi(argv[0]);
-                }
-            }
-        );
+        if (!channel.writeAll(line + "\n") || !channel.readResponse(status, body)) {
+            std::cerr << "\nLost connection to server!" << std::endl;
+            std::exit(1);
+        }
         
-        return userId;
+        return status == "OK";
     }
     
-    static std::string getUserRole(int userId) {
-        std::string role = "";
+    std::vector<Item> fetchMenu() {
+        std::vector<Item> items;
+        std::string body;
         
-        Database::getInstance().executeSelect(
-            "SELECT role FROM users WHERE id = " + std::to_string(userId),
-            [&role](int argc, char** argv, char** azColName) {
-                if (argc >= 1) {
-                    role = argv[0];
+        if (request("MENU", body)) {
+            std::istringstream lines(body);
+            std::string line;
+            
+            while (std::getline(lines, line)) {
+                std::istringstream fields(line);
+                std::string id, name, price, category;
+                
+                if (std::getline(fields, id, '\t') && std::getline(fields, name, '\t') &&
+                    std::getline(fields, price, '\t') && std::getline(fields, category)) {
+                    items.emplace_back(std::stoi(id), name, std::stoi(price), category);
                 }
             }
-        );
-        
-        return role;
-    }
-    
-    static bool addUser(const std::string& username, const std::string& password, const std::string& role) {
-        // Escape input strings to prevent SQL injection
-        std::string safeUsername = sqlEscape(username);
-        std::string safePassword = sqlEscape(password);
-        std::string safeRole = sqlEscape(role);
-        
-        std::string query = "INSERT INTO users (username, password, role) VALUES ('" +
-                          safeUsername + "', '" + safePassword + "', '" + safeRole + "')";
+        }
         
-        return Database::getInstance().executeQuery(query);
+        return items;
     }
-};
-
-// Application class (main controller)
-class HotelApp {
-private:
-    int currentUserId;
-    std::string currentUserRole;
     
 public:
-    HotelApp() : currentUserId(-1) {}
-    
-    bool initialize() {
-        std::cout << "\n\t\t\t=================================================";
-        std::cout << "\n\t\t\t|        HOTEL MANAGEMENT SYSTEM                |";
-        std::cout << "\n\t\t\t=================================================";
+    bool connect(const std::string& socketPath) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
         
-        // Connect to database
-        if (!Database::getInstance().connect()) {
-            std::cerr << "Failed to initialize database!" << std::endl;
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "Cannot connect to server at " << socketPath << std::endl;
+            if (fd >= 0) ::close(fd);
             return false;
         }
         
-        // Login
-        return login();
+        channel = SocketChannel(fd);
+        return true;
     }
     
     bool login() {
-        std::string username, password;
+        std::string username, password, body;
         int attempts = 0;
+        std::string property = chooseProperty();
         
         while (attempts < 3) {
             std::cout << "\n\n=== LOGIN ===";
@@ -515,10 +4924,10 @@ public:
             std::cout << "Password: ";
             std::cin >> password;
             
-            currentUserId = UserManager::authenticateUser(username, password);
-            
-            if (currentUserId > 0) {
-                currentUserRole = UserManager::getUserRole(currentUserId);
+            if (request("LOGIN " + username + " " + password + property, body)) {
+                std::istringstream reply(body);
+                int userId;
+                reply >> userId >> currentUserRole;
                 std::cout << "\nLogin successful! Welcome, " << username << "!";
                 return true;
             } else {
@@ -535,17 +4944,19 @@ public:
         int choice;
         
         while (true) {
-            displayMenu();
+            std::vector<Item> items = fetchMenu();
+            displayMenu(items);
             
-            // Get user choice with error handling
             if (!(std::cin >> choice)) {
+                if (std::cin.eof()) {
+                    break;
+                }
                 std::cin.clear();
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 choice = -1;  // Invalid input
             }
             
-            // Process menu choice
-            if (processMenuChoice(choice)) {
+            if (processMenuChoice(items, choice)) {
                 break;  // Exit program
             }
             
@@ -553,77 +4964,246 @@ public:
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
             std::cin.get();
         }
+        
+        std::string body;
+        request("QUIT", body);
+        ::close(channel.getFd());
     }
     
 private:
-    void displayMenu() {
-        std::vector<Item> items = InventoryManager::getAllItems();
+    // " <id>" to append to LOGIN, or nothing when the server runs one property
+    std::string chooseProperty() {
+        std::string body;
+        std::vector<std::string> ids;
+        
+        request("PROPERTIES", body);
+        std::istringstream lines(body);
+        std::string line;
+        while (std::getline(lines, line)) {
+            ids.push_back(line.substr(0, line.find('\t')));
+        }
+        
+        propertyCount = static_cast<int>(ids.size());
+        if (propertyCount < 2) {
+            return "";
+        }
+        
+        while (true) {
+            std::cout << "\n\n=== PROPERTY ===";
+            std::istringstream names(body);
+            while (std::getline(names, line)) {
+                std::cout << "\n" << line.substr(0, line.find('\t')) << ") " << line.substr(line.find('\t') + 1);
+            }
+            std::cout << "\nProperty: ";
+            
+            std::string id;
+            if (!(std::cin >> id)) {
+                return "";
+            }
+            if (std::find(ids.begin(), ids.end(), id) != ids.end()) {
+                return " " + id;
+            }
+            std::cout << "Invalid property!";
+        }
+    }
+    
+    // " ALL" when an admin asks to report on every property
+    std::string askAllProperties() {
+        if (currentUserRole != "admin" || propertyCount < 2) {
+            return "";
+        }
         
+        char answer;
+        std::cout << "\nAll properties? (y/n): ";
+        std::cin >> answer;
+        return answer == 'y' || answer == 'Y' ? " ALL" : "";
+    }
+    
+    void displayMenu(const std::vector<Item>& items) {
         std::cout << "\n\n\t\t\t Please select from the menu options ";
         
         int menuIndex = 1;
         
-        // Display inventory items
         for (const auto& item : items) {
             std::cout << "\n" << menuIndex++ << ") " << item.getName() 
                      << " - $" << item.getPrice();
         }
         
-        // Display admin options
+        std::cout << "\n" << menuIndex++ << ") Order multiple items";
+        std::cout << "\n" << menuIndex++ << ") Book a room";
         std::cout << "\n" << menuIndex++ << ") View sales report";
         std::cout << "\n" << menuIndex++ << ") View inventory status";
         
         if (currentUserRole == "admin") {
             std::cout << "\n" << menuIndex++ << ") Reset daily sales";
             std::cout << "\n" << menuIndex++ << ") Add new user";
+            std::cout << "\n" << menuIndex++ << ") Revenue report";
+            std::cout << "\n" << menuIndex++ << ") Query statistics";
         }
         
         std::cout << "\n" << menuIndex << ") Exit";
         std::cout << "\n\nPlease Enter your choice: ";
     }
     
-    bool processMenuChoice(int choice) {
-        std::vector<Item> items = InventoryManager::getAllItems();
+    bool processMenuChoice(const std::vector<Item>& items, int choice) {
+        std::string body;
         
-        // Handle item purchases (1 to items.size())
         if (choice >= 1 && choice <= static_cast<int>(items.size())) {
-            int index = choice - 1;
             int quantity;
-            
-            std::cout << "\n\nEnter " << items[index].getName() << " quantity: ";
+            std::cout << "\n\nEnter " << items[choice - 1].getName() << " quantity: ";
             std::cin >> quantity;
             
             if (quantity > 0) {
-                OrderManager::processOrder(items[index].getId(), quantity, currentUserId);
+                request("ORDER " + std::to_string(items[choice - 1].getId()) + " " + std::to_string(quantity), body);
+                std::cout << body;
             } else {
                 std::cout << "\nInvalid quantity!";
             }
-            
-            return false;  // Don't exit
+            return false;
         }
         
-        // Handle special options
         int specialOptionStart = items.size() + 1;
+        bool isAdmin = currentUserRole == "admin";
         
         if (choice == specialOptionStart) {
-            // View sales report
-            ReportManager::displayDailySales();
-        } 
+            std::string cart;
+            
+            std::cout << "\n=== Order Multiple Items ===";
+            std::cout << "\nEnter item number and quantity for each line (0 to finish)";
+            
+            while (true) {
+                int number, quantity;
+                std::cout << "\nItem number: ";
+                
+                if (!(std::cin >> number) || number == 0) {
+                    break;
+                }
+                if (number < 1 || number > static_cast<int>(items.size())) {
+                    std::cout << "Invalid item!";
+                    continue;
+                }
+                
+                std::cout << items[number - 1].getName() << " quantity: ";
+                std::cin >> quantity;
+                
+                if (quantity > 0) {
+                    cart += " " + std::to_string(items[number - 1].getId()) + ":" + std::to_string(quantity);
+                } else {
+                    std::cout << "Invalid quantity!";
+                }
+            }
+            
+            if (!std::cin) {
+                std::cin.clear();
+            }
+            
+            request("CART" + cart, body);
+            std::cout << body;
+        }
         else if (choice == specialOptionStart + 1) {
-            // View inventory status
-            ReportManager::displayInventoryStatus();
+            int number, nights;
+            std::string checkIn;
+            
+            std::cout << "\n=== Book a Room ===";
+            std::cout << "\nRoom type (menu number): ";
+            std::cin >> number;
+            
+            if (!std::cin || number < 1 || number > static_cast<int>(items.size()) ||
+                items[number - 1].getCategory() != "accommodation") {
+                std::cin.clear();
+                std::cout << "Invalid room type!";
+                return false;
+            }
+            
+            std::cout << "Check-in date (YYYY-MM-DD): ";
+            std::cin >> checkIn;
+            std::cout << "Nights: ";
+            std::cin >> nights;
+            
+            std::string itemId = std::to_string(items[number - 1].getId());
+            bool booked = request("BOOK " + itemId + " " + checkIn + " " + std::to_string(nights), body);
+            std::cout << body;
+            
+            if (!booked && request("FINDROOM " + itemId + " " + std::to_string(nights) + " " + checkIn + " 60", body)) {
+                std::string room, nextCheckIn, nextCheckOut;
+                std::istringstream(body) >> room >> nextCheckIn >> nextCheckOut;
+                
+                char answer;
+                std::cout << "\nNext opening: room " << room << " from " << nextCheckIn
+                          << " to " << nextCheckOut << ". Book it? (y/n): ";
+                std::cin >> answer;
+                
+                if (answer == 'y' || answer == 'Y') {
+                    request("BOOK " + itemId + " " + nextCheckIn + " " + std::to_string(nights), body);
+                    std::cout << body;
+                }
+            }
         }
-        else if (currentUserRole == "admin" && choice == specialOptionStart + 2) {
-            // Reset daily sales (admin only)
-            ReportManager::resetDailySales();
+        else if (choice == specialOptionStart + 2) {
+            request("SALES", body);
+            std::cout << body;
         }
-        else if (currentUserRole == "admin" && choice == specialOptionStart + 3) {
-            // Add new user (admin only)
-            addNewUser();
+        else if (choice == specialOptionStart + 3) {
+            request("INVENTORY" + askAllProperties(), body);
+            std::cout << body;
         }
-        else if ((currentUserRole == "admin" && choice == specialOptionStart + 4) ||
-                 (currentUserRole != "admin" && choice == specialOptionStart + 2)) {
-            // Exit
+        else if (isAdmin && choice == specialOptionStart + 4) {
+            std::cout << "\nDo you want to archive today's sales data? (y/n): ";
+            char answer;
+            std::cin >> answer;
+            
+            if (answer == 'y' || answer == 'Y') {
+                if (request("EXPORT", body)) {
+                    std::cout << body << "\nSales data has been archived successfully!" << std::endl;
+                } else {
+                    std::cout << "\nFailed to archive sales data.";
+                }
+            }
+        }
+        else if (isAdmin && choice == specialOptionStart + 5) {
+            std::string username, password, role;
+            
+            std::cout << "\n=== Add New User ===";
+            std::cout << "\nUsername: ";
+            std::cin >> username;
+            std::cout << "Password: ";
+            std::cin >> password;
+            std::cout << "Role (admin/staff): ";
+            std::cin >> role;
+            
+            if (!UserManager::isValidRole(role)) {
+                std::cout << "\nInvalid role! Using 'staff' as default.";
+                role = "staff";
+            }
+            
+            if (request("ADDUSER " + username + " " + password + " " + role, body)) {
+                std::cout << "\nUser added successfully!";
+            } else {
+                std::cout << "\nFailed to add user. Username may already exist.";
+            }
+        }
+        else if (isAdmin && choice == specialOptionStart + 6) {
+            std::string period, grouping, fromDate, toDate;
+            
+            std::cout << "\n=== Revenue Report ===";
+            std::cout << "\nPeriod (hour/day/week/month): ";
+            std::cin >> period;
+            std::cout << "Group by (item/category/user): ";
+            std::cin >> grouping;
+            std::cout << "From date (YYYY-MM-DD): ";
+            std::cin >> fromDate;
+            std::cout << "To date (YYYY-MM-DD): ";
+            std::cin >> toDate;
+            
+            request("REVENUE " + period + " " + grouping + " " + fromDate + " " + toDate + askAllProperties(), body);
+            std::cout << body;
+        }
+        else if (isAdmin && choice == specialOptionStart + 7) {
+            request("STATS", body);
+            std::cout << body;
+        }
+        else if ((isAdmin && choice == specialOptionStart + 8) ||
+                 (!isAdmin && choice == specialOptionStart + 4)) {
             std::cout << "\nExiting program...";
             return true;
         }
@@ -633,37 +5213,173 @@ private:
         
         return false;
     }
+};
+#endif
+
+int main(int argc, char* argv[]) {
+    std::string mode;
+    DatabaseConfig config;
+    std::vector<std::pair<std::string, std::string>> properties;  // name, database path
+    std::string exportFrom, exportTo;
+    bool exportGzip = false;
+    std::string batchPath;
+    int commitEvery = 100;
+    std::string importPath;
+#ifndef _WIN32
+    ServerConfig serverConfig;
+#endif
     
-    void addNewUser() {
-        std::string username, password, role;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
         
-        std::cout << "\n=== Add New User ===";
-        std::cout << "\nUsername: ";
-        std::cin >> username;
-        std::cout << "Password: ";
-        std::cin >> password;
-        std::cout << "Role (admin/staff): ";
-        std::cin >> role;
+        if (arg == "--server" || arg == "--client") {
+            mode = arg;
+        }
+        else if (arg == "--stats") {
+            config.queryStats = true;
+        }
+        else if (arg == "--profile" && i + 1 < argc && parseStorageProfile(argv[i + 1], config.profile)) {
+            i++;
+        }
+        else if (arg == "--hot-days" && i + 1 < argc) {
+            config.hotSalesDays = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--archive-every" && i + 1 < argc) {
+            config.archiveInterval = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--export" && i + 2 < argc) {
+            exportFrom = argv[++i];
+            exportTo = argv[++i];
+        }
+        else if (arg == "--gzip") {
+            exportGzip = true;
+        }
+        else if (arg == "--import" && i + 1 < argc) {
+            importPath = argv[++i];
+        }
+        else if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        }
+        else if (arg == "--commit-every" && i + 1 < argc) {
+            commitEvery = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--property" && i + 1 < argc && std::strchr(argv[i + 1], '=')) {
+            std::string spec = argv[++i];
+            size_t equals = spec.find('=');
+            properties.emplace_back(spec.substr(0, equals), spec.substr(equals + 1));
+        }
+#ifndef _WIN32
+        else if (arg == "--socket" && i + 1 < argc) {
+            serverConfig.socketPath = argv[++i];
+        }
+        else if (arg == "--workers" && i + 1 < argc) {
+            serverConfig.workers = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--queue" && i + 1 < argc) {
+            serverConfig.queueCapacity = std::max(1, std::atoi(argv[++i]));
+        }
+#endif
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--server | --client] [--socket PATH] [--workers N] [--queue N] [--stats]"
+                      << " [--profile durable|balanced|fast] [--hot-days N] [--archive-every S] [--property NAME=PATH ...]"
+                      << " [--export FROM TO [--gzip]] [--batch FILE|- [--commit-every N]]"
+                      << " [--import CATALOG]" << std::endl;
+            return 1;
+        }
+    }
+    
+#ifndef _WIN32
+    if (mode == "--server") {
+        config.readerPoolSize = serverConfig.workers;
+    }
+#endif
         
-        if (role != "admin" && role != "staff") {
-            std::cout << "\nInvalid role! Using 'staff' as default.";
-            role = "staff";
+    // Each --property is a hotel with its own database; without any, hotel.db is the only one
+    if (mode != "--client") {
+        for (const auto& property : properties) {
+            if (!PropertyRouter::addProperty(property.first, property.second, config)) {
+                PropertyRouter::closeAll();
+                return 1;
+            }
+        }
+    }
+
+    // --export writes one range of the first property's sales and exits, without logging in
+    if (!exportFrom.empty() && mode.empty()) {
+        bool ok = (PropertyRouter::count() > 0 || PropertyRouter::addProperty("Main", "hotel.db", config)) &&
+                  ReportManager::exportSalesRange(exportFrom, exportTo, exportGzip);
+        PropertyRouter::closeAll();
+        return ok ? 0 : 1;
+    }
+
+    // --import loads a supplier catalog into the first property's inventory and exits
+    if (!importPath.empty() && mode.empty()) {
+        bool ok = (PropertyRouter::count() > 0 || PropertyRouter::addProperty("Main", "hotel.db", config)) &&
+                  InventoryImporter::importFile(importPath);
+        PropertyRouter::closeAll();
+        return ok ? 0 : 1;
+    }
+    
+    // --batch runs a script of requests (from stdin for "-") and exits
+    if (!batchPath.empty() && mode.empty()) {
+        std::ifstream file;
+        if (batchPath != "-") {
+            file.open(batchPath);
+            if (!file) {
+                std::cerr << "Error: Unable to open " << batchPath << std::endl;
+                return 1;
+            }
         }
         
-        if (UserManager::addUser(username, password, role)) {
-            std::cout << "\nUser added successfully!";
-        } else {
-            std::cout << "\nFailed to add user. Username may already exist.";
+        bool ok = PropertyRouter::count() > 0 || PropertyRouter::addProperty("Main", "hotel.db", config);
+        if (ok) {
+            BatchRunner runner(commitEvery);
+            ok = runner.run(batchPath == "-" ? std::cin : file);
         }
+        PropertyRouter::closeAll();
+        return ok ? 0 : 1;
     }
-};
 
-int main() {
+#ifndef _WIN32
+    if (mode == "--server") {
+        if (PropertyRouter::count() == 0 && !PropertyRouter::addProperty("Main", "hotel.db", config)) {
+            std::cerr << "Failed to initialize database!" << std::endl;
+            return 1;
+        }
+        
+        OrderServer server(serverConfig);
+        bool ok = server.run();
+        PropertyRouter::closeAll();
+        return ok ? 0 : 1;
+    }
+    
+    if (mode == "--client") {
+        RemoteClient client;
+        
+        std::cout << "\n\t\t\t=================================================";
+        std::cout << "\n\t\t\t|        HOTEL MANAGEMENT SYSTEM                |";
+        std::cout << "\n\t\t\t=================================================";
+        
+        if (client.connect(serverConfig.socketPath) && client.login()) {
+            client.run();
+        }
+        return 0;
+    }
+#else
+    if (!mode.empty()) {
+        std::cerr << "Server mode is not available on this platform" << std::endl;
+        return 1;
+    }
+#endif
+    
     HotelApp app;
     
-    if (app.initialize()) {
+    if (app.initialize(config)) {
         app.run();
     }
     
+    PropertyRouter::closeAll();
+    
     return 0;
 }
\ No newline at end of file
@@ -1,47 +1,284 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <iomanip>
 #include <limits>
 #include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <unordered_map>
+#include <filesystem>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "trace.h"
 
 using namespace std;
 
 // Class for individual items (food or rooms)
+// Quantity and sold share one atomic word, so an order can check stock and
+// take it in a single compare-and-swap: items can be ordered from many
+// threads at once without a lock and are never oversold. The word sits on its
+// own cache line so orders for different items do not slow each other down.
 class Item {
+public:
+    // Quantity and sold as they stood at one instant
+    struct Counts {
+        int quantity;
+        int sold;
+        
+        int remaining() const { return quantity - sold; }
+        bool operator==(const Counts& other) const { return quantity == other.quantity && sold == other.sold; }
+    };
+
 private:
     string name;
     int price;
-    int quantity;
-    int sold;
+    alignas(64) atomic<uint64_t> stock;     // quantity in the high half, sold in the low half
+    
+    static uint64_t pack(int quantity, int sold) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(quantity)) << 32) | static_cast<uint32_t>(sold);
+    }
+    
+    static Counts unpack(uint64_t word) {
+        return Counts{static_cast<int32_t>(word >> 32), static_cast<int32_t>(word & 0xffffffffu)};
+    }
+    
+    // Apply change to the counts until no other thread got in between; change returns false to give up
+    template <typename Change>
+    bool update(Change change) {
+        uint64_t current = stock.load(memory_order_relaxed);
+        while (true) {
+            Counts counts = unpack(current);
+            if (!change(counts)) {
+                return false;
+            }
+            if (stock.compare_exchange_weak(current, pack(counts.quantity, counts.sold),
+                                            memory_order_acq_rel, memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
 
 public:
     // Constructor
-    Item(string name, int price, int quantity = 0) : name(name), price(price), quantity(quantity), sold(0) {}
+    Item(string name, int price, int quantity = 0) : name(name), price(price), stock(pack(quantity, 0)) {}
+    
+    // Copies take the counts as they stand; only used while the inventory is being built
+    Item(const Item& other) : name(other.name), price(other.price), stock(other.stock.load()) {}
+    
+    Item& operator=(const Item& other) {
+        name = other.name;
+        price = other.price;
+        stock.store(other.stock.load());
+        return *this;
+    }
 
     // Getters and setters
     string getName() const { return name; }
     int getPrice() const { return price; }
-    int getQuantity() const { return quantity; }
-    int getSold() const { return sold; }
-    int getRemaining() const { return quantity - sold; }
-    int getTotalSales() const { return sold * price; }
+    Counts getCounts() const { return unpack(stock.load(memory_order_acquire)); }
+    int getQuantity() const { return getCounts().quantity; }
+    int getSold() const { return getCounts().sold; }
+    int getRemaining() const { return getCounts().remaining(); }
+    int getTotalSales() const { return getSold() * price; }
 
-    void setQuantity(int qty) { quantity = qty; }
+    void setQuantity(int qty) {
+        update([qty](Counts& counts) { counts.quantity = qty; return true; });
+    }
+    
+    // Restore the sold counter from saved data
+    void setSold(int count) {
+        update([count](Counts& counts) { counts.sold = count; return true; });
+    }
     
     // Function to process an order
     bool order(int qty) {
-        if (getRemaining() >= qty) {
-            sold += qty;
+        return update([qty](Counts& counts) {
+            if (counts.remaining() < qty) {
+                return false;
+            }
+            counts.sold += qty;
             return true;
-        }
-        return false;
+        });
     }
     
     // Reset sales data
     void resetSales() {
-        sold = 0;
+        setSold(0);
+    }
+};
+
+// How often buffered log records are written out
+enum class FlushPolicy {
+    Sync,           // write and flush on the caller's thread for every record
+    EveryRecords,   // flush once flushEvery records are waiting
+    EveryInterval   // flush every flushIntervalMs milliseconds
+};
+
+struct LoggerConfig {
+    FlushPolicy policy = FlushPolicy::EveryRecords;
+    size_t flushEvery = 64;
+    int flushIntervalMs = 200;
+    size_t capacity = 4096;     // records buffered before producers have to wait
+};
+
+// Append-only log with a long-lived file handle. Producers push formatted
+// records into a fixed ring; a background thread writes them out in batches.
+// drain() returns once everything pushed so far is on disk.
+class TransactionLogger {
+private:
+    string fileName;
+    LoggerConfig config;
+    ofstream file;
+    
+    vector<string> ring;
+    size_t head;
+    size_t count;
+    bool writing;
+    bool flushRequested;
+    bool stopping;
+    
+    mutex lock;
+    condition_variable wakeWriter;
+    condition_variable spaceFree;
+    condition_variable batchWritten;
+    thread writer;
+
+    void writerLoop() {
+        unique_lock<mutex> guard(lock);
+        
+        while (true) {
+            auto ready = [this] {
+                return stopping || flushRequested ||
+                       (config.policy == FlushPolicy::EveryRecords && count >= config.flushEvery);
+            };
+            
+            if (config.policy == FlushPolicy::EveryInterval) {
+                wakeWriter.wait_for(guard, chrono::milliseconds(config.flushIntervalMs), ready);
+            } else {
+                wakeWriter.wait(guard, ready);
+            }
+            
+            if (count == 0) {
+                flushRequested = false;
+                batchWritten.notify_all();
+                if (stopping) {
+                    break;
+                }
+                continue;
+            }
+            
+            // Take the whole backlog and write it without holding the lock
+            string batch;
+            while (count > 0) {
+                batch += ring[head];
+                ring[head].clear();
+                head = (head + 1) % ring.size();
+                count--;
+            }
+            writing = true;
+            spaceFree.notify_all();
+            
+            guard.unlock();
+            {
+                TRACE_SPAN("TransactionLogger::writeBatch", "log");
+                file << batch;
+                file.flush();
+            }
+            guard.lock();
+            
+            writing = false;
+            batchWritten.notify_all();
+        }
+    }
+
+public:
+    TransactionLogger(const string& fileName, const LoggerConfig& config = LoggerConfig())
+        : fileName(fileName), config(config), ring(max<size_t>(config.capacity, 1)),
+          head(0), count(0), writing(false), flushRequested(false), stopping(true) {
+        open();
+    }
+
+    ~TransactionLogger() {
+        close();
+    }
+
+    bool isOpen() const { return file.is_open(); }
+
+    void open() {
+        file.open(fileName, ios::app);
+        
+        if (config.policy != FlushPolicy::Sync && file) {
+            stopping = false;
+            writer = thread(&TransactionLogger::writerLoop, this);
+        }
+    }
+
+    // Write everything still buffered, then release the file
+    void close() {
+        if (writer.joinable()) {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            wakeWriter.notify_one();
+            writer.join();
+        }
+        
+        file.close();
+    }
+
+    void log(string record) {
+        unique_lock<mutex> guard(lock);
+        
+        if (config.policy == FlushPolicy::Sync) {
+            file << record;
+            file.flush();
+            return;
+        }
+        
+        spaceFree.wait(guard, [this] { return count < ring.size(); });
+        
+        ring[(head + count) % ring.size()] = move(record);
+        count++;
+        
+        if (config.policy == FlushPolicy::EveryRecords && count >= config.flushEvery) {
+            wakeWriter.notify_one();
+        }
+    }
+
+    // Block until every record logged so far has been written and flushed
+    void drain() {
+        TRACE_SPAN("TransactionLogger::drain", "log");
+        
+        unique_lock<mutex> guard(lock);
+        
+        if (!writer.joinable()) {
+            file.flush();
+            return;
+        }
+        
+        flushRequested = true;
+        wakeWriter.notify_one();
+        batchWritten.wait(guard, [this] { return count == 0 && !writing; });
     }
 };
 
@@ -51,10 +288,103 @@ private:
     vector<Item> inventory;
     string dataFile;
     string customerLogFile;
+    TransactionLogger logger;
+
+    // Timestamp of the last logged order, reused while the clock is in the same second
+    time_t lastLogTime;
+    char lastLogTimeStr[80];
+
+    // Orders since the last snapshot are appended to the journal and replayed
+    // on startup. Each snapshot starts a new generation; journal records from
+    // older generations are already part of the snapshot and are skipped.
+    string journalFile;
+    ofstream journal;
+    int generation;
+    int journalRecords;
+    static const int compactThreshold = 1000;
+
+    // Batches leave journal records buffered until flushJournal() ends a group;
+    // groupStart is the journal's size when the open group began
+    bool groupedJournal;
+    uintmax_t groupStart;
+
+    // Data files ending in ".bin" use the compact binary snapshot format:
+    // "HOTB", then int32 version, generation and item count, then per item
+    // int32 name length, the name bytes, int32 price, quantity and sold
+    // (native byte order)
+    bool binarySnapshot;
+    static constexpr const char* binaryMagic = "HOTB";
+    static const int32_t binaryVersion = 1;
+
+    // Orders reserve stock without locking; these keep the files in step.
+    // An order holds snapshotGate shared from its reservation until its journal
+    // record is written, so a snapshot (taken exclusive) never counts an order
+    // the journal has not seen. journalMutex orders the log and journal writes.
+    shared_mutex snapshotGate;
+    mutex journalMutex;
+    
+    // Bumped before and after a reset or restock (odd while one runs), so
+    // takeSnapshot() can tell a pass that overlapped one
+    atomic<unsigned> adjustments;
+    
+    // Force a file's or directory's contents to disk; closing or flushing a
+    // stream only hands them to the OS, which may lose them in a power cut
+    static bool syncFile(const string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+#else
+        return true;
+#endif
+    }
+    
+    static bool parseInt(string_view text, int& value) {
+        auto result = from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == errc() && result.ptr == text.data() + text.size();
+    }
+    
+    // Split one CSV line into fields, honouring quoted fields with "" escapes;
+    // false if a quote is left open
+    static bool splitCsv(const string& line, vector<string>& fields) {
+        fields.assign(1, string());
+        bool quoted = false;
+        
+        for (size_t i = 0; i < line.size(); i++) {
+            char c = line[i];
+            if (quoted) {
+                if (c != '"') {
+                    fields.back() += c;
+                } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                    fields.back() += '"';
+                    i++;
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else if (c != '\r') {
+                fields.back() += c;
+            }
+        }
+        
+        return !quoted;
+    }
 
 public:
     // Constructor
-    Hotel(string fileName = "hotel_data.txt") : dataFile(fileName), customerLogFile("customer_log.txt") {
+    Hotel(string fileName = "hotel_data.txt", const LoggerConfig& logConfig = LoggerConfig())
+        : dataFile(fileName), customerLogFile("customer_log.txt"),
+          logger(customerLogFile, logConfig), lastLogTime(0),
+          journalFile(fileName + ".journal"), generation(0), journalRecords(0), groupedJournal(false), groupStart(0),
+          binarySnapshot(fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".bin") == 0),
+          adjustments(0) {
         // Initialize default inventory
         inventory.push_back(Item("Room", 1200));
         inventory.push_back(Item("Pasta", 250));
@@ -65,6 +395,9 @@ public:
         
         // Try to load data from file
         loadData();
+        replayJournal();
+        
+        journal.open(journalFile, ios::app);
     }
 
     // Initialize inventory quantities
@@ -75,7 +408,7 @@ public:
             int qty;
             cout << "\n" << inventory[i].getName() << " available: ";
             cin >> qty;
-            inventory[i].setQuantity(qty);
+            adjust([&] { inventory[i].setQuantity(qty); });
         }
         
         // Save the updated inventory to file
@@ -98,6 +431,8 @@ public:
 
     // Process a customer order
     void processOrder(int choice) {
+        TRACE_SPAN("Hotel::processOrder", "order");
+        
         if (choice < 1 || choice > static_cast<int>(inventory.size())) {
             cout << "\nInvalid choice!";
             return;
@@ -108,117 +443,383 @@ public:
         cout << "\n\n Enter " << inventory[index].getName() << " quantity: ";
         cin >> quant;
         
-        if (inventory[index].order(quant)) {
-            cout << "\n\n\t\t" << quant << " " << inventory[index].getName();
+        placeOrder(index, quant);
+    }
+
+    // Order quant units of the item at index; logs, saves and prints the bill to out on success.
+    // Safe to call from several threads at once.
+    bool placeOrder(int index, int quant, ostream& out = cout) {
+        TRACE_SPAN("Hotel::placeOrder", "order");
+        
+        Item& item = inventory[index];
+        bool compact, sync;
+        {
+            shared_lock<shared_mutex> inFlight(snapshotGate);
             
-            if (inventory[index].getName() == "Room") {
-                cout << "(s) have been allotted to you";
-            } else {
-                cout << " is the order!";
+            if (!item.order(quant)) {
+                out << "\n\tOnly " << item.getRemaining() << " " 
+                     << item.getName() << " remaining in hotel ";
+                return false;
             }
             
+            lock_guard<mutex> guard(journalMutex);
+            
             // Log this transaction
-            logTransaction(inventory[index].getName(), quant, inventory[index].getPrice());
+            logTransaction(item.getName(), quant, item.getPrice());
             
-            // Save after each successful order
+            // Record the order in the journal
+            compact = appendJournal(item.getName(), quant);
+            sync = !groupedJournal && !compact;
+        }
+        
+        // Outside the locks, so orders waiting on the disk share one another's syncs;
+        // a snapshot syncs everything itself, and a group is synced when it is written
+        if (sync && !syncFile(journalFile)) {
+            cout << "\nWarning: Unable to sync journal, saving full snapshot";
+            compact = true;
+        }
+        if (compact) {
             saveData();
-            
-            // Show bill for this item
-            cout << "\n\n Bill details:";
-            cout << "\n Item: " << inventory[index].getName();
-            cout << "\n Quantity: " << quant; 
-            cout << "\n Price per item: $" << inventory[index].getPrice();
-            cout << "\n Total: $" << quant * inventory[index].getPrice() << endl;
+        }
+        
+        out << "\n\n\t\t" << quant << " " << item.getName();
+        
+        if (item.getName() == "Room") {
+            out << "(s) have been allotted to you";
         } else {
-            cout << "\n\tOnly " << inventory[index].getRemaining() << " " 
-                 << inventory[index].getName() << " remaining in hotel ";
+            out << " is the order!";
+        }
+        
+        // Show bill for this item
+        out << "\n\n Bill details:";
+        out << "\n Item: " << item.getName();
+        out << "\n Quantity: " << quant; 
+        out << "\n Price per item: $" << item.getPrice();
+        out << "\n Total: $" << quant * item.getPrice() << endl;
+        return true;
+    }
+    
+    // Run a change that can move counters backwards (reset, restock) with no
+    // order in flight, and make snapshots taken meanwhile try again
+    template <typename Change>
+    void adjust(Change change) {
+        unique_lock<shared_mutex> quiet(snapshotGate);
+        adjustments.fetch_add(1, memory_order_acq_rel);
+        change();
+        adjustments.fetch_add(1, memory_order_acq_rel);
+    }
+    
+    // Counts for every item at one instant, without holding up orders.
+    // Orders only ever raise sold, so two identical passes over the items mean
+    // nothing changed in between; a reset or restock during the passes makes
+    // adjustments differ and the passes are repeated.
+    vector<Item::Counts> takeSnapshot() const {
+        vector<Item::Counts> first(inventory.size()), second(inventory.size());
+        
+        while (true) {
+            unsigned before = adjustments.load(memory_order_acquire);
+            for (size_t i = 0; i < inventory.size(); i++) {
+                first[i] = inventory[i].getCounts();
+            }
+            for (size_t i = 0; i < inventory.size(); i++) {
+                second[i] = inventory[i].getCounts();
+            }
+            
+            if (before % 2 == 0 && adjustments.load(memory_order_acquire) == before && first == second) {
+                return first;
+            }
+            this_thread::yield();
         }
     }
 
     // Display sales information
     void displaySalesInfo() {
+        TRACE_SPAN("Hotel::displaySalesInfo", "report");
+        
         cout << "\n\tDetails of sales and collection ";
         
         int totalCollection = 0;
+        vector<Item::Counts> snapshot = takeSnapshot();
         
-        for (const Item& item : inventory) {
-            cout << "\n\n Number of " << item.getName() << " we had: " << item.getQuantity();
-            cout << "\n Number of " << item.getName() << " we sold: " << item.getSold();
-            cout << "\n Remaining " << item.getName() << ": " << item.getRemaining();
-            cout << "\n Total " << item.getName() << " collection for the day: $" << item.getTotalSales();
+        for (size_t i = 0; i < inventory.size(); i++) {
+            const Item& item = inventory[i];
+            const Item::Counts& counts = snapshot[i];
+            int collection = counts.sold * item.getPrice();
+            
+            cout << "\n\n Number of " << item.getName() << " we had: " << counts.quantity;
+            cout << "\n Number of " << item.getName() << " we sold: " << counts.sold;
+            cout << "\n Remaining " << item.getName() << ": " << counts.remaining();
+            cout << "\n Total " << item.getName() << " collection for the day: $" << collection;
             
-            totalCollection += item.getTotalSales();
+            totalCollection += collection;
         }
         
         cout << "\n\n\n Total collection for the day: $" << totalCollection;
     }
 
-    // Save data to file
+    // Save a full snapshot and start a new journal generation.
+    // The snapshot is written to a temporary file, synced and renamed into
+    // place, so a crash or power cut leaves either the old or the new snapshot intact.
     void saveData() {
-        ofstream outFile(dataFile);
+        TRACE_SPAN("Hotel::saveData", "storage");
+        
+        // Wait for orders in flight to reach the journal, and hold new ones off
+        unique_lock<shared_mutex> quiet(snapshotGate);
+        lock_guard<mutex> guard(journalMutex);
+        
+        string tempFile = dataFile + ".tmp";
+        ofstream outFile(tempFile, ios::binary);
         
         if (!outFile) {
             cout << "\nError: Unable to open file for writing!";
             return;
         }
         
-        for (const Item& item : inventory) {
-            outFile << item.getName() << "," 
-                   << item.getPrice() << "," 
-                   << item.getQuantity() << "," 
-                   << item.getSold() << endl;
+        if (binarySnapshot) {
+            writeBinarySnapshot(outFile, generation + 1);
+        } else {
+            outFile << "#generation," << (generation + 1) << "\n";
+            
+            for (const Item& item : inventory) {
+                outFile << item.getName() << "," 
+                       << item.getPrice() << "," 
+                       << item.getQuantity() << "," 
+                       << item.getSold() << "\n";
+            }
         }
         
         outFile.close();
+        
+        if (!outFile || !syncFile(tempFile)) {
+            cout << "\nError: Unable to write data file!";
+            return;
+        }
+        
+        if (rename(tempFile.c_str(), dataFile.c_str()) != 0) {
+            // Some platforms will not rename over an existing file
+            remove(dataFile.c_str());
+            if (rename(tempFile.c_str(), dataFile.c_str()) != 0) {
+                cout << "\nError: Unable to replace data file!";
+                return;
+            }
+        }
+        
+        // The rename itself is only durable once the directory is synced
+        string directory = filesystem::path(dataFile).parent_path().string();
+        syncFile(directory.empty() ? "." : directory);
+        
+        generation++;
+        
+        // The old records now belong to a past generation; clearing them just saves space
+        journal.close();
+        journal.open(journalFile, ios::trunc);
+        journalRecords = 0;
+        groupStart = 0;
     }
 
-    // Load data from file
-    void loadData() {
-        ifstream inFile(dataFile);
+    // Bytes in the journal file, 0 if it cannot be read
+    uintmax_t journalSize() const {
+        error_code error;
+        uintmax_t size = filesystem::file_size(journalFile, error);
+        return error ? 0 : size;
+    }
+
+    // Append one order to the journal; returns true once it has grown past the
+    // threshold (or cannot be written) and a snapshot should be saved. In a
+    // group both are left to flushJournal(), so a snapshot never holds part of
+    // a group that is then not written. Called with journalMutex held.
+    bool appendJournal(const string& itemName, int quantity) {
+        TRACE_SPAN("Hotel::appendJournal", "storage");
         
-        if (!inFile) {
-            cout << "\nNo previous data found. Starting with empty inventory.";
-            return;
+        journal << generation << ",ORDER," << itemName << "," << quantity << "\n";
+        if (groupedJournal) {
+            journalRecords++;
+            return false;
         }
+        journal.flush();
         
+        if (!journal) {
+            cout << "\nWarning: Unable to write journal, saving full snapshot";
+            return true;
+        }
+        
+        return ++journalRecords >= compactThreshold;
+    }
+
+    // Re-apply orders recorded since the last snapshot
+    void replayJournal() {
+        TRACE_SPAN("Hotel::replayJournal", "storage");
+        
+        ifstream inFile(journalFile);
         string line;
-        inventory.clear();
         
         while (getline(inFile, line)) {
+            // Format: generation,ORDER,name,quantity
+            size_t first = line.find(',');
+            size_t second = line.find(',', first + 1);
+            size_t last = line.rfind(',');
+            
+            if (first == string::npos || second == string::npos || last <= second) {
+                break;  // Torn record from an interrupted write
+            }
+            
             try {
-                size_t pos = 0;
-                vector<string> tokens;
+                int recordGeneration = stoi(line.substr(0, first));
+                string op = line.substr(first + 1, second - first - 1);
+                string name = line.substr(second + 1, last - second - 1);
+                int quantity = stoi(line.substr(last + 1));
                 
-                // Split the line by commas
-                while ((pos = line.find(',')) != string::npos) {
-                    tokens.push_back(line.substr(0, pos));
-                    line.erase(0, pos + 1);
+                if (recordGeneration != generation || op != "ORDER") {
+                    continue;
                 }
-                tokens.push_back(line);
                 
-                if (tokens.size() == 4) {
-                    string name = tokens[0];
-                    int price = stoi(tokens[1]);
-                    int quantity = stoi(tokens[2]);
-                    int sold = stoi(tokens[3]);
-                    
-                    Item item(name, price, quantity);
-                    // Manually set sold items since we don't have a direct setter
-                    for (int i = 0; i < sold; i++) {
-                        item.order(1);
+                for (Item& item : inventory) {
+                    if (item.getName() == name) {
+                        item.order(quantity);
+                        break;
                     }
-                    
-                    inventory.push_back(item);
                 }
-            } catch (const exception& e) {
-                cout << "\nError parsing file: " << e.what();
-                inventory.clear();
+                journalRecords++;
+            } catch (const exception&) {
                 break;
             }
         }
+    }
+
+    void writeBinarySnapshot(ofstream& outFile, int32_t snapshotGeneration) {
+        auto writeInt = [&outFile](int32_t value) {
+            outFile.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        
+        outFile.write(binaryMagic, 4);
+        writeInt(binaryVersion);
+        writeInt(snapshotGeneration);
+        writeInt(static_cast<int32_t>(inventory.size()));
         
+        for (const Item& item : inventory) {
+            string name = item.getName();
+            writeInt(static_cast<int32_t>(name.size()));
+            outFile.write(name.data(), name.size());
+            writeInt(item.getPrice());
+            writeInt(item.getQuantity());
+            writeInt(item.getSold());
+        }
+    }
+
+    bool parseBinarySnapshot(const string& contents) {
+        size_t pos = 4;
+        auto readInt = [&contents, &pos](int32_t& value) {
+            if (pos + sizeof(value) > contents.size()) {
+                return false;
+            }
+            memcpy(&value, contents.data() + pos, sizeof(value));
+            pos += sizeof(value);
+            return true;
+        };
+        
+        int32_t version, snapshotGeneration, count;
+        if (!readInt(version) || version != binaryVersion ||
+            !readInt(snapshotGeneration) || !readInt(count) || count < 0) {
+            cout << "\nError parsing file: bad binary header";
+            return false;
+        }
+        
+        generation = snapshotGeneration;
+        inventory.reserve(count);
+        
+        for (int32_t i = 0; i < count; i++) {
+            int32_t nameLength, price, quantity, sold;
+            if (!readInt(nameLength) || nameLength < 0 || pos + nameLength > contents.size()) {
+                cout << "\nError parsing file: truncated binary snapshot";
+                return false;
+            }
+            
+            string name = contents.substr(pos, nameLength);
+            pos += nameLength;
+            
+            if (!readInt(price) || !readInt(quantity) || !readInt(sold)) {
+                cout << "\nError parsing file: truncated binary snapshot";
+                return false;
+            }
+            
+            inventory.push_back(Item(name, price, quantity));
+            inventory.back().setSold(sold);
+        }
+        
+        return true;
+    }
+
+    bool parseTextSnapshot(const string& contents) {
+        size_t pos = 0;
+        
+        while (pos < contents.size()) {
+            size_t end = contents.find('\n', pos);
+            if (end == string::npos) {
+                end = contents.size();
+            }
+            
+            string_view line(contents.data() + pos, end - pos);
+            pos = end + 1;
+            
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            
+            // Snapshot header written by saveData
+            if (line.compare(0, 12, "#generation,") == 0) {
+                parseInt(line.substr(12), generation);
+                continue;
+            }
+            
+            // Format: name,price,quantity,sold; other lines are ignored
+            size_t soldPos = line.rfind(',');
+            size_t quantityPos = soldPos == string_view::npos || soldPos == 0 ? string_view::npos : line.rfind(',', soldPos - 1);
+            size_t pricePos = quantityPos == string_view::npos || quantityPos == 0 ? string_view::npos : line.rfind(',', quantityPos - 1);
+            
+            if (pricePos == string_view::npos) {
+                continue;
+            }
+            
+            int price, quantity, sold;
+            if (!parseInt(line.substr(pricePos + 1, quantityPos - pricePos - 1), price) ||
+                !parseInt(line.substr(quantityPos + 1, soldPos - quantityPos - 1), quantity) ||
+                !parseInt(line.substr(soldPos + 1), sold)) {
+                cout << "\nError parsing file: invalid number in \"" << line << "\"";
+                return false;
+            }
+            
+            inventory.push_back(Item(string(line.substr(0, pricePos)), price, quantity));
+            inventory.back().setSold(sold);
+        }
+        
+        return true;
+    }
+
+    // Load data from file
+    void loadData() {
+        TRACE_SPAN("Hotel::loadData", "storage");
+        
+        ifstream inFile(dataFile, ios::binary | ios::ate);
+        
+        if (!inFile) {
+            cout << "\nNo previous data found. Starting with empty inventory.";
+            return;
+        }
+        
+        // Read the whole snapshot in one call and parse it in place
+        string contents(static_cast<size_t>(inFile.tellg()), '\0');
+        inFile.seekg(0);
+        inFile.read(&contents[0], contents.size());
         inFile.close();
         
+        inventory.clear();
+        
+        bool parsed = contents.compare(0, 4, binaryMagic) == 0 ? parseBinarySnapshot(contents)
+                                                                : parseTextSnapshot(contents);
+        if (!parsed) {
+            inventory.clear();
+        }
+        
         if (inventory.empty()) {
             cout << "\nInvalid data format. Starting with default inventory.";
             // Reinitialize with default inventory
@@ -233,26 +834,27 @@ public:
         }
     }
 
-    // Log transaction to customer log file
+    // Log transaction to customer log file; called with journalMutex held
     void logTransaction(const string& itemName, int quantity, int price) {
-        ofstream logFile(customerLogFile, ios::app);
-        if (!logFile) {
+        TRACE_SPAN("Hotel::logTransaction", "log");
+        
+        if (!logger.isOpen()) {
             cout << "\nWarning: Unable to log transaction!";
             return;
         }
         
         // Get current time
         time_t now = time(0);
-        tm* localTime = localtime(&now);
-        char timeStr[80];
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localTime);
-        
-        logFile << timeStr << " - Item: " << itemName 
-                << ", Quantity: " << quantity 
-                << ", Price: $" << price 
-                << ", Total: $" << (quantity * price) << endl;
+        if (now != lastLogTime) {
+            tm* localTime = localtime(&now);
+            strftime(lastLogTimeStr, sizeof(lastLogTimeStr), "%Y-%m-%d %H:%M:%S", localTime);
+            lastLogTime = now;
+        }
         
-        logFile.close();
+        logger.log(string(lastLogTimeStr) + " - Item: " + itemName
+                   + ", Quantity: " + to_string(quantity)
+                   + ", Price: $" + to_string(price)
+                   + ", Total: $" + to_string(quantity * price) + "\n");
     }
     
     // Reset sales data for a new day
@@ -262,20 +864,168 @@ public:
         cin >> choice;
         
         if (choice == 'y' || choice == 'Y') {
+            resetSales();
+        }
+    }
+    
+    // Clear every item's sales, save, and archive the customer log
+    void resetSales() {
+        adjust([this] {
             for (Item& item : inventory) {
                 item.resetSales();
             }
+        });
+        saveData();
+        
+        // Archive the customer log file
+        archiveLogFile();
+        
+        cout << "\nSales data has been reset for a new day!";
+    }
+    
+    // Set the stock of the item at index and save
+    void restock(int index, int quantity) {
+        adjust([&] { inventory[index].setQuantity(quantity); });
+        saveData();
+    }
+    
+    // Add or update items from a supplier catalog: CSV with a header row naming
+    // at least "name" and "price" (whole dollars), optionally "quantity".
+    // Items are matched by name; a blank quantity keeps the current stock and
+    // sold counts are kept. Bad rows are skipped and reported by line, the rest
+    // saved in one snapshot. Call before orders are taken, as the inventory may grow.
+    bool importCatalog(istream& in, ostream& out = cout) {
+        TRACE_SPAN("Hotel::importCatalog", "storage");
+        auto started = chrono::steady_clock::now();
+        
+        string line;
+        vector<string> fields;
+        int nameCol = -1, priceCol = -1, quantityCol = -1;
+        
+        if (!getline(in, line) || !splitCsv(line, fields)) {
+            out << "Import failed: missing header row" << endl;
+            return false;
+        }
+        for (size_t i = 0; i < fields.size(); i++) {
+            string column;
+            for (char c : fields[i]) {
+                if (c != ' ') {
+                    column += tolower(static_cast<unsigned char>(c));
+                }
+            }
+            if (column == "name") nameCol = i;
+            else if (column == "price") priceCol = i;
+            else if (column == "quantity") quantityCol = i;
+        }
+        if (nameCol < 0 || priceCol < 0) {
+            out << "Import failed: header needs name and price columns" << endl;
+            return false;
+        }
+        
+        unordered_map<string, size_t> byName;
+        for (size_t i = 0; i < inventory.size(); i++) {
+            byName.emplace(inventory[i].getName(), i);
+        }
+        
+        int inserted = 0, updated = 0, rejected = 0;
+        int lineNumber = 1;
+        
+        adjust([&] {
+            while (getline(in, line)) {
+                lineNumber++;
+                if (line.empty() || line == "\r") {
+                    continue;
+                }
+                
+                string problem;
+                int price = 0, quantity = -1;
+                
+                if (!splitCsv(line, fields)) {
+                    problem = "unterminated quote";
+                } else if ((int)fields.size() <= max(nameCol, max(priceCol, quantityCol))) {
+                    problem = "missing fields";
+                } else if (fields[nameCol].empty()) {
+                    problem = "missing name";
+                } else if (!parseInt(fields[priceCol], price) || price < 0) {
+                    problem = "price must be a whole number of dollars";
+                } else if (quantityCol >= 0 && !fields[quantityCol].empty() &&
+                           (!parseInt(fields[quantityCol], quantity) || quantity < 0)) {
+                    problem = "quantity must be a whole number";
+                }
+                
+                if (!problem.empty()) {
+                    if (++rejected <= 10) {
+                        out << "Line " << lineNumber << " rejected: " << problem << endl;
+                    }
+                    continue;
+                }
+                
+                auto found = byName.find(fields[nameCol]);
+                if (found == byName.end()) {
+                    byName.emplace(fields[nameCol], inventory.size());
+                    inventory.push_back(Item(fields[nameCol], price, max(quantity, 0)));
+                    inserted++;
+                } else {
+                    Item& item = inventory[found->second];
+                    Item::Counts counts = item.getCounts();
+                    item = Item(item.getName(), price, quantity < 0 ? counts.quantity : quantity);
+                    item.setSold(counts.sold);
+                    updated++;
+                }
+            }
+        });
+        
+        if (inserted + updated > 0) {
             saveData();
+        }
+        
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        out << "Imported " << inserted << " new items, updated " << updated
+            << ", rejected " << rejected << " in " << fixed << setprecision(2) << seconds << " s" << endl;
+        return true;
+    }
+    
+    // Buffer journal records from now on instead of writing each order out;
+    // flushJournal() writes them, so a crash loses at most the open group
+    void groupJournal() {
+        lock_guard<mutex> guard(journalMutex);
+        groupedJournal = true;
+        groupStart = journalSize();
+    }
+    
+    // Write out buffered journal and customer log records; false if the journal
+    // cannot be written. A group that fails is cut from the journal again, so
+    // a restart does not replay orders that were reported as not written.
+    bool flushJournal() {
+        TRACE_SPAN("Hotel::flushJournal", "storage");
+        
+        bool compact;
+        {
+            lock_guard<mutex> guard(journalMutex);
+            journal.flush();
+            if (!journal || !syncFile(journalFile)) {
+                journal.close();
+                error_code ignored;
+                filesystem::resize_file(journalFile, groupStart, ignored);
+                journal.open(journalFile, ios::app);
+                return false;
+            }
             
-            // Archive the customer log file
-            archiveLogFile();
-            
-            cout << "\nSales data has been reset for a new day!";
+            groupStart = journalSize();
+            compact = journalRecords >= compactThreshold;
+        }
+        
+        logger.drain();
+        if (compact) {
+            saveData();
         }
+        return true;
     }
     
     // Archive log file with date
     void archiveLogFile() {
+        TRACE_SPAN("Hotel::archiveLogFile", "log");
+        
         // Get current date for archive filename
         time_t now = time(0);
         tm* localTime = localtime(&now);
@@ -284,6 +1034,10 @@ public:
         
         string archiveFile = "customer_log_" + string(dateStr) + ".txt";
         
+        // Write out buffered records and release the log while it is copied
+        lock_guard<mutex> guard(journalMutex);
+        logger.close();
+        
         ifstream src(customerLogFile);
         ofstream dst(archiveFile);
         
@@ -300,6 +1054,8 @@ public:
         } else {
             cout << "\nWarning: Unable to archive log file!";
         }
+        
+        logger.open();
     }
     
     // Get number of items in inventory
@@ -314,6 +1070,8 @@ public:
     
     // Process menu choice
     bool processMenuChoice(int choice) {
+        TRACE_SPAN("Hotel::processMenuChoice", "ui");
+        
         // Handle item purchases
         if (choice >= 1 && choice <= static_cast<int>(inventory.size())) {
             processOrder(choice);
@@ -349,17 +1107,85 @@ public:
 // Class for handling user authentication
 class Authentication {
 private:
+    // One line of users.txt; id is the line number
+    struct Account {
+        int id;
+        string password;
+        string role;
+    };
+
     string usersFile;
     string currentUser;
+    string currentRole;
     bool isLoggedIn;
 
+    // Index of users.txt, reloaded when the file's mtime or size changes
+    unordered_map<string, Account> accounts;
+    time_t loadedMtime;
+    off_t loadedSize;
+    bool loaded;
+
+    void loadUsers() {
+        TRACE_SPAN("Authentication::loadUsers", "auth");
+        
+        accounts.clear();
+        
+        ifstream file(usersFile);
+        string line;
+        int lineNumber = 0;
+        
+        while (getline(file, line)) {
+            lineNumber++;
+            
+            // Format: username,password,role
+            size_t first = line.find(',');
+            if (first == string::npos) {
+                continue;
+            }
+            size_t second = line.find(',', first + 1);
+            
+            Account account;
+            account.id = lineNumber;
+            if (second == string::npos) {
+                account.password = line.substr(first + 1);
+            } else {
+                account.password = line.substr(first + 1, second - first - 1);
+                account.role = line.substr(second + 1);
+            }
+            
+            // Same precedence as the old line scan: the first matching line wins
+            accounts.emplace(line.substr(0, first), move(account));
+        }
+    }
+
+    void refreshUsers() {
+        struct stat info;
+        if (stat(usersFile.c_str(), &info) != 0) {
+            accounts.clear();
+            loaded = false;
+            return;
+        }
+        
+        if (loaded && info.st_mtime == loadedMtime && info.st_size == loadedSize) {
+            return;
+        }
+        
+        loadUsers();
+        loadedMtime = info.st_mtime;
+        loadedSize = info.st_size;
+        loaded = true;
+    }
+
 public:
-    Authentication(string fileName = "users.txt") : usersFile(fileName), isLoggedIn(false) {
+    Authentication(string fileName = "users.txt")
+        : usersFile(fileName), isLoggedIn(false), loadedMtime(0), loadedSize(0), loaded(false) {
         // Check if users file exists, if not, create an admin user
         ifstream file(usersFile);
         if (!file) {
             createDefaultAdmin();
         }
+        
+        refreshUsers();
     }
 
     // Create default admin user if no users exist
@@ -385,9 +1211,7 @@ public:
             cout << "Password: ";
             cin >> password;
             
-            if (validateUser(username, password)) {
-                currentUser = username;
-                isLoggedIn = true;
+            if (signIn(username, password)) {
                 cout << "\nLogin successful! Welcome, " << username << "!";
                 return true;
             } else {
@@ -400,32 +1224,51 @@ public:
         return false;
     }
 
-    // Validate user credentials
-    bool validateUser(const string& username, const string& password) {
-        ifstream file(usersFile);
-        if (!file) {
+    // Log in without prompting; false if the credentials do not match
+    bool signIn(const string& username, const string& password) {
+        const Account* account = findUser(username, password);
+        if (!account) {
             return false;
         }
         
-        string line;
-        while (getline(file, line)) {
-            size_t pos = line.find(',');
-            if (pos != string::npos) {
-                string storedUsername = line.substr(0, pos);
-                line.erase(0, pos + 1);
-                
-                pos = line.find(',');
-                if (pos != string::npos) {
-                    string storedPassword = line.substr(0, pos);
-                    
-                    if (username == storedUsername && password == storedPassword) {
-                        return true;
-                    }
-                }
-            }
+        currentUser = username;
+        currentRole = account->role;
+        isLoggedIn = true;
+        return true;
+    }
+
+    // Append an account to the users file; false if the username is taken
+    // or a field cannot be stored in it
+    bool addUser(const string& username, const string& password, const string& role) {
+        refreshUsers();
+        
+        if (username.empty() || username.find(',') != string::npos || password.find(',') != string::npos ||
+            (role != "admin" && role != "staff") || accounts.count(username) != 0) {
+            return false;
         }
         
-        return false;
+        ofstream file(usersFile, ios::app);
+        file << username << "," << password << "," << role << endl;
+        return static_cast<bool>(file);
+    }
+
+    // Look up credentials; returns the account (id and role) or nullptr.
+    // The pointer is valid until the next lookup.
+    const Account* findUser(const string& username, const string& password) {
+        TRACE_SPAN("Authentication::findUser", "auth");
+        
+        refreshUsers();
+        
+        auto it = accounts.find(username);
+        if (it == accounts.end() || it->second.password != password) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    // Validate user credentials
+    bool validateUser(const string& username, const string& password) {
+        return findUser(username, password) != nullptr;
     }
 
     // Check if user is logged in
@@ -437,6 +1280,11 @@ public:
     string getCurrentUser() const {
         return currentUser;
     }
+
+    // Role of the current user, read once at login
+    string getCurrentRole() const {
+        return currentRole;
+    }
 };
 
 // Function to clear input buffer
@@ -452,7 +1300,217 @@ void displayHeader() {
     cout << "\n\t\t\t=================================================";
 }
 
-int main() {
+// First non-blank line of a message, trimmed
+string firstLine(const string& text) {
+    istringstream lines(text);
+    string line;
+    while (getline(lines, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start != string::npos) {
+            size_t end = line.find_last_not_of(" \t");
+            return line.substr(start, end - start + 1);
+        }
+    }
+    return "";
+}
+
+// Outcome of one batch request
+struct BatchResult {
+    int lineNumber;
+    string status;   // "OK" or "ERR <reason>"
+    string request;  // as logged, without passwords
+};
+
+// Run a script of requests without prompts, one per line:
+//   LOGIN <username> <password>      ORDER <item number> <quantity>
+//   SALES    RESET    STOCK <item number> <quantity>
+//   ADDUSER <username> <password> <role>
+// Item numbers are as on the menu; RESET, STOCK and ADDUSER need an admin.
+// Blank lines and lines starting with '#' are skipped and QUIT ends the
+// script. Orders are journaled in groups of groupSize, written out together,
+// and any other request writes out the open group first. Each request gets a
+// result line, "<line number>\t<OK or ERR reason>\t<request>", printed once
+// it is written out; SALES prints its report after it. The inventory is saved
+// at the end, unless a group could not be written: the script stops there and
+// the data file is left alone, so it never holds orders reported as failed.
+// Returns false if any request failed.
+bool runBatch(Hotel& hotel, Authentication& auth, istream& script, int groupSize) {
+    TRACE_SPAN("runBatch", "batch");
+    
+    auto started = chrono::steady_clock::now();
+    vector<BatchResult> pending;  // orders not yet written out
+    long requests = 0, failures = 0, groups = 0;
+    bool written = true;
+    
+    auto report = [&](const BatchResult& result) {
+        if (result.status != "OK") {
+            failures++;
+        }
+        cout << result.lineNumber << '\t' << result.status << '\t' << result.request << '\n';
+    };
+    
+    auto writeOut = [&]() {
+        if (pending.empty()) {
+            return true;
+        }
+        
+        bool ok = hotel.flushJournal();
+        groups += ok ? 1 : 0;
+        for (BatchResult& result : pending) {
+            if (!ok && result.status == "OK") {
+                result.status = "ERR not written";
+            }
+            report(result);
+        }
+        pending.clear();
+        return ok;
+    };
+    
+    hotel.groupJournal();
+    
+    string line;
+    int lineNumber = 0;
+    while (written && getline(script, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        
+        istringstream words(line);
+        string command;
+        if (!(words >> command) || command[0] == '#') {
+            continue;
+        }
+        if (command == "QUIT") {
+            break;
+        }
+        requests++;
+        
+        if (command == "ORDER" && auth.isUserLoggedIn()) {
+            int item = 0, quantity = 0;
+            string status = "OK";
+            ostringstream bill;
+            
+            if (!(words >> item >> quantity) || item < 1 || item > hotel.getInventorySize() || quantity <= 0) {
+                status = "ERR usage: ORDER <item number> <quantity>";
+            } else if (!hotel.placeOrder(item - 1, quantity, bill)) {
+                status = "ERR order rejected: " + firstLine(bill.str());
+            }
+            
+            pending.push_back({lineNumber, status, line});
+            if (static_cast<int>(pending.size()) >= groupSize) {
+                written = writeOut();
+            }
+            continue;
+        }
+        
+        written = writeOut();
+        if (!written) {
+            break;
+        }
+        
+        string first, second, third;
+        words >> first >> second >> third;
+        
+        if (command == "LOGIN") {
+            // Passwords stay out of the log
+            report({lineNumber, auth.signIn(first, second) ? "OK" : "ERR invalid username or password",
+                    "LOGIN " + first});
+        } else if (!auth.isUserLoggedIn()) {
+            report({lineNumber, "ERR login required", line});
+        } else if (command == "SALES") {
+            report({lineNumber, "OK", line});
+            hotel.displaySalesInfo();
+            cout << endl;
+        } else if (command != "RESET" && command != "STOCK" && command != "ADDUSER") {
+            report({lineNumber, "ERR unknown command", line});
+        } else if (auth.getCurrentRole() != "admin") {
+            report({lineNumber, "ERR admin only", command == "ADDUSER" ? command + " " + first + " " + third : line});
+        } else if (command == "RESET") {
+            report({lineNumber, "OK", line});
+            hotel.resetSales();
+            cout << endl;
+        } else if (command == "STOCK") {
+            int item = 0, quantity = -1;
+            bool valid = from_chars(first.data(), first.data() + first.size(), item).ec == errc() &&
+                         from_chars(second.data(), second.data() + second.size(), quantity).ec == errc() &&
+                         item >= 1 && item <= hotel.getInventorySize() && quantity >= 0;
+            if (valid) {
+                hotel.restock(item - 1, quantity);
+            }
+            report({lineNumber, valid ? "OK" : "ERR usage: STOCK <item number> <quantity>", line});
+        } else {
+            report({lineNumber, auth.addUser(first, second, third) ? "OK" : "ERR username taken or role invalid",
+                    command + " " + first + " " + third});
+        }
+    }
+    
+    written = writeOut() && written;
+    
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "# " << requests << " requests, " << failures << " failed, " << groups << " groups written in "
+         << fixed << setprecision(2) << seconds << " s" << endl;
+    
+    if (!written) {
+        cout << "# journal could not be written; the data file was not updated" << endl;
+        return false;
+    }
+    hotel.saveData();
+    return failures == 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Optional data file; a ".bin" name selects the binary snapshot format
+    string dataFile = "hotel_data.txt";
+    string batchPath;
+    string importPath;
+    int commitEvery = 100;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        
+        if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--commit-every" && i + 1 < argc) {
+            commitEvery = max(1, atoi(argv[++i]));
+        } else if (arg == "--import" && i + 1 < argc) {
+            importPath = argv[++i];
+        } else {
+            dataFile = arg;
+        }
+    }
+    
+    // --import adds or updates items from a supplier catalog and exits
+    if (!importPath.empty()) {
+        ifstream file(importPath);
+        if (!file) {
+            cerr << "Error: Unable to open " << importPath << endl;
+            return 1;
+        }
+        
+        Hotel hotel(dataFile);
+        cout << endl;  // after the startup messages
+        return hotel.importCatalog(file) ? 0 : 1;
+    }
+    
+    // --batch runs a script of requests (from stdin for "-") instead of the menu
+    if (!batchPath.empty()) {
+        ifstream file;
+        if (batchPath != "-") {
+            file.open(batchPath);
+            if (!file) {
+                cerr << "Error: Unable to open " << batchPath << endl;
+                return 1;
+            }
+        }
+        
+        Authentication auth;
+        Hotel hotel(dataFile);
+        cout << endl;  // after the startup messages
+        
+        return runBatch(hotel, auth, batchPath == "-" ? cin : file, commitEvery) ? 0 : 1;
+    }
+    
     displayHeader();
     
     // Authentication system
@@ -461,7 +1519,7 @@ int main() {
         return 1;  // Exit if login fails
     }
     
-    Hotel hotel;
+    Hotel hotel(dataFile);
     int choice;
     bool firstRun = true;
     
@@ -0,0 +1,567 @@
+// Workload replay for the SQLite engine (dbms.cpp) and the flat-file engine (hotel.cpp)
+//
+// Build: g++ -std=c++17 -O2 -pthread -o replay Hotel/replay.cpp -lsqlite3
+// Usage: replay (--log FILE ... | --sales DB) [--engine sqlite|flatfile] [--clerks N]
+//               [--speedup X | --rate R] [--stock N] [--limit N] [--dir PATH]
+//
+// Reads a recorded order stream, either customer_log.txt files written by
+// Hotel::logTransaction or the sales table of a hotel.db, and plays it back
+// against a fresh copy of one engine. Orders arrive open-loop: each one is due
+// at its recorded time divided by --speedup (or on a Poisson clock at --rate
+// orders/sec), whether or not earlier orders have finished. N virtual clerks
+// take orders as they fall due, so when they fall behind the wait shows up in
+// the response time. --speedup 0 replays as fast as the clerks can go.
+//
+// The result is one JSON line: throughput, response and service time
+// percentiles in microseconds, and how many orders hit a stock-out or were
+// rejected by the engine.
+
+// Every header the engines include must be listed here first; inside the
+// namespaces below their own #include lines are then no-ops.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <ctime>
+#include <unordered_map>
+#include <filesystem>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <deque>
+#include <condition_variable>
+#include <future>
+#include <algorithm>
+#include <random>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+#include <type_traits>
+#include <iterator>
+#include <charconv>
+#include <string_view>
+#include <sqlite3.h>
+#include <zlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trace.h"
+
+#define main dbms_main
+namespace dbms {
+#include "dbms.cpp"
+}
+#undef main
+
+#define main hotel_main
+namespace flatfile {
+#include "hotel.cpp"
+}
+#undef main
+
+using Clock = std::chrono::steady_clock;
+
+// Results keep going to the real stdout while the engines are silenced
+static std::ostream results(std::cout.rdbuf());
+
+struct ReplayConfig {
+    std::vector<std::string> logFiles;
+    std::string salesDb;
+    std::string engine = "sqlite";
+    int clerks = 4;
+    double speedup = 60.0;      // recorded seconds per replayed second (0 = no waiting)
+    double rate = 0.0;          // orders/sec on a Poisson clock instead of recorded times
+    int stock = 1000000000;     // starting quantity of every item
+    long limit = 0;             // replay only the first N orders (0 = all)
+    std::string dir = "replay_data";
+};
+
+// One recorded order; at is seconds after the first order in the workload
+struct ReplayOrder {
+    double at;
+    int item;
+    int quantity;
+};
+
+struct Workload {
+    std::vector<std::string> names;
+    std::vector<int> prices;
+    std::vector<ReplayOrder> orders;
+    long skipped = 0;
+    
+    int itemIndex(const std::string& name, int price) {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()) {
+            return static_cast<int>(it - names.begin());
+        }
+        names.push_back(name);
+        prices.push_back(price);
+        return static_cast<int>(names.size()) - 1;
+    }
+};
+
+// "YYYY-MM-DD HH:MM:SS" to seconds since 1970-01-01, or -1 if malformed
+static long long parseTimestamp(const std::string& text) {
+    int year, month, day, hour, minute, second;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return -1;
+    }
+    return dbms::daysFromCivil(year, month, day) * 86400LL + hour * 3600 + minute * 60 + second;
+}
+
+// Lines look like "2025-01-31 19:04:11 - Item: Pasta, Quantity: 2, Price: $250, Total: $500"
+static bool loadLog(const std::string& path, Workload& workload, std::vector<long long>& times) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t itemPos = line.find(" - Item: ");
+        size_t quantityPos = line.rfind(", Quantity: ");
+        size_t pricePos = line.rfind(", Price: $");
+        
+        long long time = itemPos == std::string::npos ? -1 : parseTimestamp(line.substr(0, itemPos));
+        if (time < 0 || quantityPos == std::string::npos || pricePos == std::string::npos ||
+            quantityPos < itemPos || pricePos < quantityPos) {
+            workload.skipped++;
+            continue;
+        }
+        
+        std::string name = line.substr(itemPos + 9, quantityPos - itemPos - 9);
+        int quantity = std::atoi(line.c_str() + quantityPos + 12);
+        int price = std::atoi(line.c_str() + pricePos + 10);
+        if (quantity <= 0) {
+            workload.skipped++;
+            continue;
+        }
+        
+        workload.orders.push_back(ReplayOrder{0, workload.itemIndex(name, price), quantity});
+        times.push_back(time);
+    }
+    
+    return true;
+}
+
+// Read-only, so a live hotel.db can be used as the source. Months moved to
+// sales archives (see SalesArchive in dbms.cpp) are read from their files.
+static bool loadSales(const std::string& path, Workload& workload, std::vector<long long>& times) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr) != SQLITE_OK) {
+        std::cerr << "Cannot open " << path << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_busy_timeout(db, 5000);
+    
+    auto readSales = [&](const std::string& table) {
+        sqlite3_stmt* stmt = nullptr;
+        std::string query = "SELECT s.timestamp, i.name, s.quantity, s.total_price "
+                            "FROM " + table + " s JOIN main.inventory i ON s.item_id = i.id ORDER BY s.timestamp, s.id";
+        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char* timestamp = sqlite3_column_text(stmt, 0);
+            const unsigned char* name = sqlite3_column_text(stmt, 1);
+            int quantity = sqlite3_column_int(stmt, 2);
+            
+            long long time = timestamp ? parseTimestamp(reinterpret_cast<const char*>(timestamp)) : -1;
+            if (time < 0 || !name || quantity <= 0) {
+                workload.skipped++;
+                continue;
+            }
+            
+            int price = sqlite3_column_int(stmt, 3) / quantity;
+            workload.orders.push_back(ReplayOrder{0, workload.itemIndex(reinterpret_cast<const char*>(name), price), quantity});
+            times.push_back(time);
+        }
+        
+        sqlite3_finalize(stmt);
+        return true;
+    };
+    
+    bool ok = readSales("main.sales");
+    
+    // Databases created before archiving existed have no sales_archives table
+    std::vector<std::string> archives;
+    sqlite3_stmt* stmt = nullptr;
+    if (ok && sqlite3_prepare_v2(db, "SELECT file FROM sales_archives ORDER BY month", -1, &stmt, nullptr) == SQLITE_OK) {
+        std::string dir = path.find('/') == std::string::npos ? "" : path.substr(0, path.find_last_of('/') + 1);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            archives.push_back(dir + reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    for (size_t i = 0; ok && i < archives.size(); i++) {
+        std::string uri = "file:" + archives[i] + "?mode=ro";
+        ok = sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS archive", -1, &stmt, nullptr) == SQLITE_OK &&
+             sqlite3_bind_text(stmt, 1, uri.c_str(), -1, SQLITE_TRANSIENT) == SQLITE_OK &&
+             sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        
+        ok = ok && readSales("archive.sales");
+        if (!ok) {
+            std::cerr << "Cannot read sales archive " << archives[i] << ": " << sqlite3_errmsg(db) << std::endl;
+        }
+        sqlite3_exec(db, "DETACH DATABASE archive", nullptr, nullptr, nullptr);
+    }
+    
+    sqlite3_close(db);
+    return ok;
+}
+
+static bool loadWorkload(const ReplayConfig& config, Workload& workload) {
+    std::vector<long long> times;
+    
+    if (!config.salesDb.empty() && !loadSales(config.salesDb, workload, times)) {
+        return false;
+    }
+    for (const std::string& path : config.logFiles) {
+        if (!loadLog(path, workload, times)) {
+            return false;
+        }
+    }
+    
+    if (workload.skipped > 0) {
+        std::cerr << "Skipped " << workload.skipped << " unreadable records" << std::endl;
+    }
+    if (workload.orders.empty()) {
+        std::cerr << "No orders to replay" << std::endl;
+        return false;
+    }
+    
+    // Archived logs may be given in any order; keep same-second orders as recorded
+    std::vector<size_t> order(workload.orders.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&times](size_t a, size_t b) { return times[a] < times[b]; });
+    
+    if (config.limit > 0 && static_cast<size_t>(config.limit) < order.size()) {
+        order.resize(config.limit);
+    }
+    
+    std::vector<ReplayOrder> sorted;
+    sorted.reserve(order.size());
+    long long first = times[order.front()];
+    for (size_t index : order) {
+        sorted.push_back(workload.orders[index]);
+        sorted.back().at = static_cast<double>(times[index] - first);
+    }
+    workload.orders.swap(sorted);
+    
+    return true;
+}
+
+// When each order falls due, in seconds after the replay starts
+static std::vector<double> schedule(const ReplayConfig& config, const Workload& workload) {
+    std::vector<double> due(workload.orders.size(), 0.0);
+    
+    if (config.rate > 0) {
+        std::mt19937_64 random(42);
+        std::exponential_distribution<double> gap(config.rate);
+        double at = 0;
+        for (double& next : due) {
+            next = at;
+            at += gap(random);
+        }
+    } else if (config.speedup > 0) {
+        for (size_t i = 0; i < due.size(); i++) {
+            due[i] = workload.orders[i].at / config.speedup;
+        }
+    }
+    
+    return due;
+}
+
+enum class Outcome {
+    Filled,
+    StockOut,
+    Rejected
+};
+
+struct ReplayResult {
+    std::vector<double> response;   // from when the order fell due until it finished
+    std::vector<double> service;    // from when a clerk started it until it finished
+    long filled = 0;
+    long stockOuts = 0;
+    long rejected = 0;
+};
+
+// Replay due orders with config.clerks threads; place(clerk, order) runs one order
+static ReplayResult replay(const ReplayConfig& config, const Workload& workload,
+                           const std::function<Outcome(int, const ReplayOrder&)>& place, double& elapsed) {
+    std::vector<double> due = schedule(config, workload);
+    std::vector<ReplayResult> perClerk(config.clerks);
+    std::atomic<size_t> next(0);
+    
+    auto start = Clock::now();
+    bool paced = config.rate > 0 || config.speedup > 0;
+    
+    std::vector<std::thread> clerks;
+    for (int clerk = 0; clerk < config.clerks; clerk++) {
+        clerks.emplace_back([&, clerk] {
+            ReplayResult& mine = perClerk[clerk];
+            
+            for (size_t i = next++; i < workload.orders.size(); i = next++) {
+                auto dueAt = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(due[i]));
+                if (paced) {
+                    std::this_thread::sleep_until(dueAt);
+                }
+                
+                auto begin = Clock::now();
+                Outcome outcome = place(clerk, workload.orders[i]);
+                auto end = Clock::now();
+                
+                if (!paced) {
+                    dueAt = begin;
+                }
+                mine.response.push_back(std::chrono::duration<double, std::micro>(end - dueAt).count());
+                mine.service.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                
+                switch (outcome) {
+                    case Outcome::Filled: mine.filled++; break;
+                    case Outcome::StockOut: mine.stockOuts++; break;
+                    case Outcome::Rejected: mine.rejected++; break;
+                }
+            }
+        });
+    }
+    
+    for (auto& clerk : clerks) {
+        clerk.join();
+    }
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    ReplayResult total;
+    for (ReplayResult& part : perClerk) {
+        total.response.insert(total.response.end(), part.response.begin(), part.response.end());
+        total.service.insert(total.service.end(), part.service.begin(), part.service.end());
+        total.filled += part.filled;
+        total.stockOuts += part.stockOuts;
+        total.rejected += part.rejected;
+    }
+    return total;
+}
+
+static void report(const ReplayConfig& config, const Workload& workload, ReplayResult& result, double elapsed) {
+    std::sort(result.response.begin(), result.response.end());
+    std::sort(result.service.begin(), result.service.end());
+    
+    auto percentile = [](const std::vector<double>& latencies, double p) {
+        size_t index = static_cast<size_t>(p * (latencies.size() - 1));
+        return latencies[index];
+    };
+    
+    std::string mode = config.rate > 0 ? "rate" : config.speedup > 0 ? "speedup" : "flat-out";
+    double recorded = workload.orders.back().at;
+    
+    results << std::fixed << std::setprecision(2)
+            << "{\"engine\":\"" << config.engine << "\",\"mode\":\"" << mode << "\""
+            << ",\"clerks\":" << config.clerks
+            << ",\"speedup\":" << config.speedup << ",\"rate\":" << config.rate
+            << ",\"orders\":" << workload.orders.size()
+            << ",\"recorded_sec\":" << recorded
+            << ",\"elapsed_sec\":" << elapsed
+            << ",\"orders_per_sec\":" << workload.orders.size() / elapsed
+            << ",\"p50_us\":" << percentile(result.response, 0.50)
+            << ",\"p95_us\":" << percentile(result.response, 0.95)
+            << ",\"p99_us\":" << percentile(result.response, 0.99)
+            << ",\"max_us\":" << result.response.back()
+            << ",\"service_p50_us\":" << percentile(result.service, 0.50)
+            << ",\"service_p99_us\":" << percentile(result.service, 0.99)
+            << ",\"filled\":" << result.filled
+            << ",\"stock_outs\":" << result.stockOuts
+            << ",\"rejected\":" << result.rejected << "}" << std::endl;
+}
+
+static bool replayDatabase(const ReplayConfig& config, const Workload& workload) {
+    const std::string path = "replay.db";
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    
+    dbms::Database& db = dbms::Database::getInstance();
+    
+    dbms::DatabaseConfig dbConfig;
+    dbConfig.readerPoolSize = config.clerks;
+    
+    if (!db.connect(path, dbConfig)) {
+        return false;
+    }
+    
+    // Every replayed item at the configured stock, and one user per clerk
+    db.executeQuery("BEGIN");
+    for (size_t i = 0; i < workload.names.size(); i++) {
+        dbms::Statement stmt = db.prepare("INSERT OR IGNORE INTO inventory (name, price, quantity, category) "
+                                          "VALUES (?, ?, 0, ?)");
+        stmt.bind(1, workload.names[i]).bind(2, workload.prices[i])
+            .bind(3, std::string(workload.names[i] == "Room" ? "accommodation" : "food"));
+        stmt.execute();
+    }
+    {
+        dbms::Statement stmt = db.prepare("UPDATE inventory SET quantity = ?");
+        stmt.bind(1, config.stock);
+        stmt.execute();
+    }
+    for (int clerk = 1; clerk <= config.clerks; clerk++) {
+        dbms::Statement stmt = db.prepare("INSERT OR IGNORE INTO users (username, password, role) VALUES (?, ?, 'staff')");
+        stmt.bind(1, "clerk" + std::to_string(clerk)).bind(2, std::string("replay"));
+        stmt.execute();
+    }
+    db.executeQuery("COMMIT");
+    dbms::InventoryManager::invalidateCatalog();
+    
+    std::vector<int> itemIds;
+    for (const std::string& name : workload.names) {
+        dbms::Statement stmt = db.prepare("SELECT id FROM inventory WHERE name = ?");
+        stmt.bind(1, name);
+        itemIds.push_back(stmt.step() ? stmt.getInt(0) : 0);
+    }
+    std::vector<int> userIds;
+    for (int clerk = 1; clerk <= config.clerks; clerk++) {
+        dbms::Statement stmt = db.prepare("SELECT id FROM users WHERE username = ?");
+        stmt.bind(1, "clerk" + std::to_string(clerk));
+        userIds.push_back(stmt.step() ? stmt.getInt(0) : 1);
+    }
+    
+    // processOrder only says whether the order went through; its message tells a
+    // stock-out from a busy database
+    std::vector<std::ostringstream> bills(config.clerks);
+    
+    double elapsed = 0;
+    ReplayResult result = replay(config, workload, [&](int clerk, const ReplayOrder& order) {
+        std::ostringstream& out = bills[clerk];
+        out.str("");
+        if (dbms::OrderManager::processOrder(itemIds[order.item], order.quantity, userIds[clerk], out)) {
+            return Outcome::Filled;
+        }
+        return out.str().find("Not enough inventory") != std::string::npos ? Outcome::StockOut : Outcome::Rejected;
+    }, elapsed);
+    
+    report(config, workload, result, elapsed);
+    db.close();
+    return true;
+}
+
+// Discards program output while the flat-file engine runs. The buffer keeps
+// no state, so clerks on several threads can print warnings through it.
+class QuietStdout {
+private:
+    struct Discard : std::streambuf {
+        int overflow(int ch) override { return traits_type::not_eof(ch); }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+    
+    Discard discard;
+    std::streambuf* saved;
+
+public:
+    QuietStdout() : saved(std::cout.rdbuf(&discard)) {}
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+};
+
+static bool replayFlatFile(const ReplayConfig& config, const Workload& workload) {
+    const std::string path = "replay_data.txt";
+    std::remove(path.c_str());
+    std::remove((path + ".journal").c_str());
+    std::remove("customer_log.txt");
+    
+    {
+        std::ofstream data(path);
+        for (size_t i = 0; i < workload.names.size(); i++) {
+            data << workload.names[i] << "," << workload.prices[i] << "," << config.stock << ",0\n";
+        }
+    }
+    
+    QuietStdout quiet;
+    flatfile::Hotel hotel(path);
+    
+    // placeOrder is safe to call from every clerk at once; each prints its bills to its own buffer
+    std::vector<std::ostringstream> bills(config.clerks);
+    
+    double elapsed = 0;
+    ReplayResult result = replay(config, workload, [&](int clerk, const ReplayOrder& order) {
+        std::ostringstream& out = bills[clerk];
+        out.str("");
+        return hotel.placeOrder(order.item, order.quantity, out) ? Outcome::Filled : Outcome::StockOut;
+    }, elapsed);
+    
+    report(config, workload, result, elapsed);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ReplayConfig config;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--log" && hasValue) {
+            config.logFiles.push_back(argv[++i]);
+        } else if (arg == "--sales" && hasValue) {
+            config.salesDb = argv[++i];
+        } else if (arg == "--engine" && hasValue) {
+            config.engine = argv[++i];
+        } else if (arg == "--clerks" && hasValue) {
+            config.clerks = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--speedup" && hasValue) {
+            config.speedup = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--rate" && hasValue) {
+            config.rate = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--stock" && hasValue) {
+            config.stock = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--limit" && hasValue) {
+            config.limit = std::max(0L, std::atol(argv[++i]));
+        } else if (arg == "--dir" && hasValue) {
+            config.dir = argv[++i];
+        } else {
+            config.engine.clear();
+            break;
+        }
+    }
+    
+    if ((config.logFiles.empty() && config.salesDb.empty()) ||
+        (config.engine != "sqlite" && config.engine != "flatfile")) {
+        std::cerr << "Usage: " << argv[0] << " (--log FILE ... | --sales DB) [--engine sqlite|flatfile] [--clerks N]"
+                  << " [--speedup X | --rate R] [--stock N] [--limit N] [--dir PATH]" << std::endl;
+        return 1;
+    }
+    
+    // Sources are read before moving into the scratch directory, so relative paths work
+    Workload workload;
+    if (!loadWorkload(config, workload)) {
+        return 1;
+    }
+    
+    ::mkdir(config.dir.c_str(), 0755);
+    if (::chdir(config.dir.c_str()) != 0) {
+        std::cerr << "Cannot enter " << config.dir << std::endl;
+        return 1;
+    }
+    
+    bool replayed = config.engine == "sqlite" ? replayDatabase(config, workload) : replayFlatFile(config, workload);
+    return replayed ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// Span tracing shared by dbms.cpp and hotel.cpp
+//
+// Run either program with HOTEL_TRACE=<file> to record where time goes:
+//
+//     HOTEL_TRACE=trace.json ./dbms
+//
+// Every TRACE_SPAN("name") records how long its enclosing scope took. Spans go
+// to a buffer owned by the recording thread, and the whole session is written
+// at exit as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev open.
+// Without HOTEL_TRACE a span costs one branch on a cached flag.
+
+#ifndef HOTEL_TRACE_H
+#define HOTEL_TRACE_H
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    // One complete ("X") event; name and category must be string literals
+    struct Event {
+        const char* name;
+        const char* category;
+        std::string detail;
+        Clock::time_point start;
+        Clock::duration duration;
+    };
+
+private:
+    // Events recorded by one thread. Buffers outlive their threads so spans
+    // from finished workers still reach the file; the mutex is only contended
+    // while the file is being written.
+    struct ThreadBuffer {
+        int threadId;
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+    
+    // Leaked on purpose: detached threads may still record while exit handlers run
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+    
+    static Registry& registry() {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+    
+    static inline const Clock::time_point origin = Clock::now();
+    
+    static const char* outputPath() {
+        static const char* path = std::getenv("HOTEL_TRACE");
+        return path && *path ? path : nullptr;
+    }
+    
+    static ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* local = nullptr;
+        if (local) {
+            return *local;
+        }
+        
+        Registry& all = registry();
+        std::lock_guard<std::mutex> guard(all.mutex);
+        if (all.buffers.empty()) {
+            std::atexit(&Tracer::write);
+        }
+        
+        all.buffers.push_back(std::make_unique<ThreadBuffer>());
+        local = all.buffers.back().get();
+        local->threadId = static_cast<int>(all.buffers.size());
+        return *local;
+    }
+    
+    static void writeEscaped(std::ostream& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out << ' ';
+            } else {
+                out << c;
+            }
+        }
+    }
+
+public:
+    static bool enabled() {
+        static const bool on = outputPath() != nullptr;
+        return on;
+    }
+    
+    static void record(Event event) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> guard(buffer.mutex);
+        buffer.events.push_back(std::move(event));
+    }
+    
+    // Write every recorded span to the HOTEL_TRACE file; registered with atexit
+    static void write() {
+        std::ofstream file(outputPath());
+        if (!file) {
+            return;
+        }
+        
+        auto micros = [](Clock::duration duration) {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        };
+        
+        file << std::fixed;
+        file.precision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        
+        bool first = true;
+        Registry& all = registry();
+        std::lock_guard<std::mutex> guard(all.mutex);
+        for (const auto& buffer : all.buffers) {
+            std::lock_guard<std::mutex> bufferGuard(buffer->mutex);
+            
+            for (const Event& event : buffer->events) {
+                file << (first ? "\n" : ",\n")
+                     << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\""
+                     << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                     << ",\"ts\":" << micros(event.start - origin)
+                     << ",\"dur\":" << micros(event.duration);
+                if (!event.detail.empty()) {
+                    file << ",\"args\":{\"detail\":\"";
+                    writeEscaped(file, event.detail);
+                    file << "\"}";
+                }
+                file << "}";
+                first = false;
+            }
+        }
+        
+        file << "\n]}\n";
+    }
+};
+
+// Records the lifetime of the enclosing scope as one span
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    std::string detail;
+    Tracer::Clock::time_point start;
+    bool active;
+
+public:
+    explicit TraceSpan(const char* name, const char* category = "hotel")
+        : name(name), category(category), active(Tracer::enabled()) {
+        if (active) {
+            start = Tracer::Clock::now();
+        }
+    }
+    
+    // The detail text (e.g. SQL) is only copied while tracing is on
+    TraceSpan(const char* name, const char* category, const std::string& text)
+        : TraceSpan(name, category) {
+        if (active) {
+            detail = text;
+        }
+    }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    
+    ~TraceSpan() {
+        if (active) {
+            Tracer::record({name, category, std::move(detail), start, Tracer::Clock::now() - start});
+        }
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// TRACE_SPAN("name") or TRACE_SPAN("name", "category") or TRACE_SPAN("name", "category", detail)
+#define TRACE_SPAN(...) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
+
+#endif